@@ -1,30 +1,43 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "driver/dac_oneshot.h" // Requires ESP-IDF v5.x
 #include "esp_log.h"
 #include "esp_random.h"
-#include "driver/mcpwm_cap.h" // Capture Driver
-
-#define CAPTURE_GPIO 27
+#include "esp_spiffs.h"
+#include "plant_model.h"
+#include "pwm_capture.h"
+#include "sim_pipeline.h"
+#include "sim_trace.h"
+#include "wasm_plant.h"
 
 // --- PINS for TTGO T-Display ---
 #define PIN_DAC_CHAN DAC_CHAN_0 // GPIO 25 (Right side, 3rd pin from bottom)
-// #define PIN_HEATER_IN 27        // GPIO 27 (Right side, bottom pin)
+#define PIN_HEATER_IN 27        // GPIO 27 (Right side, bottom pin), heater PWM in
+
+// --- HEATER PWM DECODING (see pwm_capture.h) ---
+#define PWM_WINDOW_CYCLES 16    // 16 ms of duty per reading at the controller's 1 kHz
+#define PWM_STALE_US 20000      // No edges for 20 ms: 0 % or 100 % duty
+
+// --- PLANT (see plant_model.h) ---
+#define PLANT_MODEL      "first_order"  // Or "second_order", "delay"
+#define PLANT_INTEGRATOR PLANT_INTEGRATOR_RK4
+#define PLANT_DIR        "/spiffs"      // <PLANT_MODEL>.wasm here replaces the built-in model
+#define PHYSICS_STACK    8192           // Room for the WAMR interpreter
+#define TICK_MS          50             // 20Hz simulation rate
+#define MAX_TEMP         100.0f         // Temperature at full DAC scale
+#define NOISE_RANGE      0.3f           // Sensor noise +/- range
 
-// --- PHYSICS CONSTANTS (matching sim.py) ---
-#define AMBIENT_TEMP 25.0f // Room temp (C)
-#define MAX_TEMP 100.0f    // Max allowed temp
-#define HEATING_RATE 0.8f  // How fast it gains heat (deg/tick)
-#define COOLING_RATE 0.02f // How fast it loses heat to environment
-#define THERMAL_MASS 0.95f // Inertia (Higher = Slower/Smoother changes)
-#define NOISE_RANGE 0.3f   // Sensor noise +/- range
+#define TRACE_DRAIN_MS 500 // Telemetry trace drain period (sim_trace.h)
+#define JITTER_REPORT_TICKS 1200 // Tick jitter logged every minute
 
 
-static float current_temp = 25.0f; // Current temperature state
-volatile float received_heater_power = 0.0f;
+static plant_t plant;
+static wasm_plant_t wasm_plant; // Used instead of `plant` when wasm_plant.module_inst is set
+static sim_stage_t physics_stage;
 
 // Helper function for random float in range
 static float random_float(float min, float max)
@@ -34,116 +47,153 @@ static float random_float(float min, float max)
     return min + normalized * (max - min);
 }
 
-static bool on_capture_event(mcpwm_cap_channel_handle_t cap_chan, const mcpwm_capture_event_data_t *edata, void *user_data)
-{
-    static uint32_t pos_edge_timestamp = 0;
-    
-    // If Edge is Positive (Low -> High), start timer
-    if (edata->cap_edge == MCPWM_CAP_EDGE_POS) {
-        pos_edge_timestamp = edata->cap_value;
-    } 
-    // If Edge is Negative (High -> Low), calculate duration
-    else {
-        uint32_t neg_edge_timestamp = edata->cap_value;
-        uint32_t high_time_us = neg_edge_timestamp - pos_edge_timestamp;
-        
-        // Calculate Duty Cycle (Assuming 1kHz / 1000us period)
-        // 1000us = 100% power
-        float power = (float)high_time_us / 1000.0f; 
-        
-        // Simple filter/clamp
-        if(power > 1.0f) power = 1.0f;
-        if(power < 0.0f) power = 0.0f;
-        
-        received_heater_power = power;
-    }
-    return false;
-}
-
-void init_pwm_capture() {
-    // 1. Install Capture Timer (1MHz resolution = 1us per tick)
-    mcpwm_cap_timer_handle_t cap_timer = NULL;
-    mcpwm_capture_timer_config_t cap_conf = {
-        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
-        .group_id = 0,
-    };
-    ESP_ERROR_CHECK(mcpwm_capture_timer_new_default(&cap_conf, &cap_timer));
-
-    // 2. Install Capture Channel on GPIO 27
-    mcpwm_cap_channel_handle_t cap_chan = NULL;
-    mcpwm_capture_channel_config_t chan_conf = {
-        .gpio_num = CAPTURE_GPIO,
-        .prescale = 1,
-    };
-    ESP_ERROR_CHECK(mcpwm_capture_channel_new_default(cap_timer, &chan_conf, &cap_chan));
-
-    // 3. Register Callback
-    mcpwm_capture_event_callbacks_t cbs = {
-        .on_cap = on_capture_event,
-    };
-    ESP_ERROR_CHECK(mcpwm_capture_channel_register_event_callbacks(cap_chan, &cbs, NULL));
-
-    // 4. Start
-    ESP_ERROR_CHECK(mcpwm_capture_timer_enable(cap_timer));
-    ESP_ERROR_CHECK(mcpwm_capture_timer_start(cap_timer));
-    ESP_ERROR_CHECK(mcpwm_capture_channel_enable(cap_chan));
-    
-    ESP_LOGI("SIM", "PWM Capture Started on Pin %d", CAPTURE_GPIO);
-}
-
-void physics_simulation_loop()
+// Pinned to the control core, away from the capture ISR and tracing
+// (sim_pipeline.h)
+static void physics_simulation_task(void *arg)
 {
     // 1. Setup DAC (Output Temperature Voltage)
     dac_oneshot_handle_t dac_handle;
     dac_oneshot_config_t dac_cfg = {.chan_id = PIN_DAC_CHAN};
     ESP_ERROR_CHECK(dac_oneshot_new_channel(&dac_cfg, &dac_handle));
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t ticks = 0;
     while (1)
     {
-        int heater_state = gpio_get_level(PIN_HEATER_IN);
-        float heater_cmd = (float)heater_state; // 0.0 or 1.0
-
-        // B. Physics Simulation (Newton's Law of Cooling)
-        // Energy In: Heater Power
-        float energy_in = heater_cmd * HEATING_RATE;
-
-        // Energy Out: Difference between object and room temp
-        float energy_out = (current_temp - AMBIENT_TEMP) * COOLING_RATE;
-
-        // Apply Thermal Mass (Smoothing/Lag)
-        float target_next_temp = current_temp + energy_in - energy_out;
-        current_temp = (current_temp * THERMAL_MASS) + (target_next_temp * (1.0f - THERMAL_MASS));
-
-        // Clamp temperature to valid range
-        if (current_temp > MAX_TEMP)
-            current_temp = MAX_TEMP;
-        if (current_temp < AMBIENT_TEMP)
-            current_temp = AMBIENT_TEMP;
+        sim_stage_activate(&physics_stage);
+
+        // A. Heater duty decoded from the controller's PWM (proportional)
+        pwm_capture_reading_t pwm = pwm_capture_read();
+        float heater_cmd = pwm.duty;
+
+        // B. Physics Simulation: one plant-model step, command held over the tick
+        float current_temp;
+        if (wasm_plant.module_inst)
+        {
+            current_temp = wasm_plant_step(&wasm_plant, TICK_MS / 1000.0f, heater_cmd);
+        }
+        else
+        {
+            plant_step(&plant, TICK_MS / 1000.0f, heater_cmd);
+            current_temp = plant_temperature(&plant);
+        }
 
         // C. Add sensor noise for realistic readings
         float noise = random_float(-NOISE_RANGE, NOISE_RANGE);
         float simulated_reading = current_temp + noise;
 
-        // D. Output Voltage via DAC
+        // D. Output Voltage via DAC, which spans 0 .. MAX_TEMP. Plant models
+        // need not clamp, and a negative float converted to unsigned is undefined
+        if (!(simulated_reading > 0.0f))
+            simulated_reading = 0.0f;
+        if (simulated_reading > MAX_TEMP)
+            simulated_reading = MAX_TEMP;
         uint32_t dac_val = (uint32_t)((simulated_reading / MAX_TEMP) * 255.0f);
-        if (dac_val > 255)
-            dac_val = 255;
         ESP_ERROR_CHECK(dac_oneshot_output_voltage(dac_handle, dac_val));
 
-        ESP_LOGI("SIM", "Temp: %.1fC (noisy: %.1fC) -> DAC: %lu | Heater: %s",
-                 current_temp, simulated_reading, dac_val, heater_state ? "ON" : "OFF");
-        vTaskDelay(pdMS_TO_TICKS(50));
+        // Binary trace instead of formatting floats every tick
+        sim_trace(SIM_TRACE_PLANT_TEMP, 0, current_temp);
+        sim_trace(SIM_TRACE_PLANT_READING, 0, simulated_reading);
+        sim_trace(SIM_TRACE_DAC_OUT, PIN_DAC_CHAN, (float)dac_val);
+        sim_trace(SIM_TRACE_HEATER_CMD, 0, heater_cmd);
+        sim_trace(SIM_TRACE_PWM_PERIOD, pwm.stale, pwm.period_us);
+        if (++ticks % JITTER_REPORT_TICKS == 0)
+        {
+            sim_stage_report(&physics_stage);
+        }
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(TICK_MS));
+    }
+}
+
+// Load PLANT_DIR/<PLANT_MODEL>.wasm if there is one: new plants are deployed
+// by writing the storage partition, without reflashing the bridge. False
+// (nothing left allocated) when the built-in model should run.
+static bool start_wasm_plant(void)
+{
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = PLANT_DIR,
+        .partition_label = "storage",
+        .max_files = 2,
+        .format_if_mount_failed = false};
+    if (esp_vfs_spiffs_register(&conf) != ESP_OK)
+    {
+        ESP_LOGI("SIM", "No plant storage, using the built-in models");
+        return false;
+    }
+
+    static char path[64];
+    snprintf(path, sizeof(path), "%s/%s.wasm", PLANT_DIR, PLANT_MODEL);
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return false;
+    }
+    fclose(f);
+
+    RuntimeInitArgs init_args;
+    memset(&init_args, 0, sizeof(RuntimeInitArgs));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args) || !wasm_plant_register_natives())
+    {
+        ESP_LOGE("SIM", "WAMR Init Failed");
+        return false;
+    }
+
+    // The image backs the module for the bridge's whole life
+    uint8_t *image = NULL;
+    wasm_module_t module = wasm_plant_load(path, &image);
+    if (!module || !wasm_plant_create(&wasm_plant, module, path, NULL, 0))
+    {
+        if (module)
+            wasm_runtime_unload(module);
+        free(image);
+        wasm_runtime_destroy();
+        return false;
     }
+    return true;
 }
 
 void app_main(void)
 {
+    // 1. Plant model: a WASM container when one is deployed, otherwise the
+    // built-in model of that name
+    const plant_model_t *model = NULL;
+    if (start_wasm_plant())
+    {
+        ESP_LOGI("SIM", "Physics: WASM plant %s", wasm_plant.name);
+    }
+    else
+    {
+        model = plant_model_find(PLANT_MODEL);
+        if (!model)
+        {
+            ESP_LOGE("SIM", "Unknown plant model '%s'", PLANT_MODEL);
+            return;
+        }
+        plant_init(&plant, model, PLANT_INTEGRATOR);
+    }
 
-    // 2. Setup Digital Input (Read Heater Command)
-    init_pwm_capture();
+    // 2. Decode the heater command from the controller's PWM
+    pwm_capture_config_t pwm_cfg = {
+        .gpio = PIN_HEATER_IN,
+        .window_cycles = PWM_WINDOW_CYCLES,
+        .stale_us = PWM_STALE_US,
+    };
+    if (!pwm_capture_start(&pwm_cfg))
+    {
+        ESP_LOGE("SIM", "PWM capture failed: no heater input");
+        return;
+    }
     ESP_LOGI("SIM", "Simulator Running on Pins 25 (DAC) & 27 (Input)");
-    ESP_LOGI("SIM", "Physics: Ambient=%.1fC, HeatingRate=%.2f, CoolingRate=%.3f, ThermalMass=%.2f",
-             AMBIENT_TEMP, HEATING_RATE, COOLING_RATE, THERMAL_MASS);
+    if (model)
+    {
+        ESP_LOGI("SIM", "Physics: %s (%s), %s integration, Ambient=%.1fC", model->name,
+                 model->description, plant_integrator_name(PLANT_INTEGRATOR), plant.p[0]);
+    }
+
+    sim_trace_start_drain(stdout, TRACE_DRAIN_MS);
 
-    // Start physics simulation loop
-    physics_simulation_loop();
+    // Start physics simulation
+    sim_stage_init(&physics_stage, "physics", TICK_MS * 1000);
+    xTaskCreatePinnedToCore(physics_simulation_task, "physics_sim", PHYSICS_STACK, NULL,
+                            SIM_PRIO_PLANT, NULL, SIM_CORE_CONTROL);
 }
\ No newline at end of file
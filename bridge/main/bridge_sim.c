@@ -0,0 +1,183 @@
+#include <stdint.h>
+#include "bridge_sim.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "simulation_data_packet.h"
+#include "sim_state.h"
+#include "sim_trace.h"
+#include "sim_packet.h"
+#include "sim_transport.h"
+
+#define TAG "BRIDGE"
+
+// --- GLOBAL STATE ---
+static plant_bank_t plants;
+static uint32_t frame_counter = 0;
+
+// Heater commands, 0.0 (OFF) to 1.0 (ON). Written by the receive callback
+// only, read lock-free by the physics tick (see sim_state.h)
+static sim_channel_t heater_ch[PLANT_BANK_MAX];
+
+// External physics, see bridge_sim_set_external()
+static bridge_sim_external_fn external_step = NULL;
+static void *external_arg = NULL;
+
+void bridge_sim_init(uint32_t plant_count)
+{
+    if (plant_count == 0)
+        plant_count = 1;
+    plant_bank_init(&plants, plant_count);
+    frame_counter = 0;
+    for (uint32_t i = 0; i < PLANT_BANK_MAX; i++)
+    {
+        sim_channel_init(&heater_ch[i], 0.0f);
+    }
+}
+
+void bridge_sim_set_params(uint32_t plant, const plant_params_t *params)
+{
+    if (plant < plants.count)
+    {
+        plant_bank_set_params(&plants, plant, params);
+    }
+}
+
+bool bridge_sim_set_model(const char *name, plant_integrator_t integrator)
+{
+    const plant_model_t *model = NULL;
+    if (name)
+    {
+        model = plant_model_find(name);
+        if (!model)
+        {
+            ESP_LOGE(TAG, "Unknown plant model '%s'", name);
+            return false;
+        }
+    }
+    if (!plant_bank_set_model(&plants, model, integrator, BRIDGE_SIM_TICK_MS / 1000.0f))
+    {
+        ESP_LOGE(TAG, "No memory for %lu '%s' plants", (unsigned long)plants.count, name);
+        return false;
+    }
+    ESP_LOGI(TAG, "Plant model: %s (%s)", model ? model->name : "built-in",
+             model ? plant_integrator_name(integrator) : "euler, vectorized");
+    return true;
+}
+
+void bridge_sim_set_external(bridge_sim_external_fn step, void *arg)
+{
+    external_arg = arg;
+    external_step = step;
+}
+
+void bridge_sim_advance(void)
+{
+    // Snapshot the heater commands (lock-free), then step every plant at once
+    for (uint32_t i = 0; i < plants.count; i++)
+    {
+        plants.heater[i] = sim_channel_value(&heater_ch[i]);
+    }
+    if (!external_step)
+    {
+        plant_bank_step(&plants);
+        return;
+    }
+
+    const float dt = BRIDGE_SIM_TICK_MS / 1000.0f;
+    for (uint32_t i = 0; i < plants.count; i++)
+    {
+        plants.temp[i] = external_step(external_arg, i, dt, plants.heater[i]);
+    }
+    plant_bank_sample(&plants);
+}
+
+void bridge_sim_tick(void)
+{
+    bridge_sim_advance();
+
+    // Batch every sensor channel of this tick, as few frames as possible
+    sim_batch_t batch;
+    uint32_t timestamp = (uint32_t)esp_timer_get_time();
+    sim_batch_begin(&batch, SIM_DEVICE_BRIDGE, frame_counter++);
+    for (uint32_t i = 0; i < plants.count; i++)
+    {
+        uint8_t channel = SIM_PLANT_CHANNEL(i, SIM_CHANNEL_TEMPERATURE);
+        sim_trace(SIM_TRACE_PLANT_TEMP, (uint16_t)i, plants.temp[i]);
+        if (!sim_batch_add(&batch, channel, plants.reading[i], timestamp))
+        {
+            sim_transport_send(batch.buf, batch.len);
+            sim_batch_begin(&batch, SIM_DEVICE_BRIDGE, frame_counter++);
+            sim_batch_add(&batch, channel, plants.reading[i], timestamp);
+        }
+    }
+    sim_transport_send(batch.buf, batch.len);
+}
+
+void bridge_sim_set_heater(uint32_t plant, float new_cmd)
+{
+    if (plant >= plants.count)
+    {
+        return;
+    }
+
+    // Clamp heater command to 0-1 range
+    if (new_cmd <= 0.0f) new_cmd = 0.0f;
+    if (new_cmd >= 1.0f) new_cmd = 1.0f;
+
+    // Update heater command (lock-free, never blocks the receive context)
+    sim_channel_publish(&heater_ch[plant], new_cmd, esp_timer_get_time());
+    sim_trace(SIM_TRACE_HEATER_CMD, (uint16_t)plant, new_cmd);
+}
+
+void bridge_sim_on_receive(const uint8_t *data, int len)
+{
+    sim_batch_header_t header;
+    if (sim_batch_parse(data, len, &header))
+    {
+        if (header.device_id != SIM_DEVICE_CONTROLLER)
+        {
+            return;
+        }
+        sim_trace(SIM_TRACE_FRAME_RX, header.device_id, header.count);
+        for (uint8_t i = 0; i < header.count; i++)
+        {
+            sim_batch_sample_t sample;
+            sim_batch_get(data, i, &sample);
+            if (SIM_CHANNEL_KIND(sample.channel) == SIM_CHANNEL_HEATER)
+            {
+                bridge_sim_set_heater(SIM_CHANNEL_PLANT(sample.channel), sample.value);
+            }
+        }
+    }
+    else if (len == sizeof(SimPacket))
+    {
+        // Legacy single-value frame
+        const SimPacket *packet = (const SimPacket *)data;
+
+        // If packet comes from Controller (Dev ID 1) and is for Heater (ID 1)
+        if (packet->device_id == 1 && packet->id == 1)
+        {
+            bridge_sim_set_heater(0, packet->value);
+        }
+    }
+}
+
+uint32_t bridge_sim_plant_count(void)
+{
+    return plants.count;
+}
+
+float bridge_sim_temperature(uint32_t plant)
+{
+    return plants.temp[plant];
+}
+
+float bridge_sim_reading(uint32_t plant)
+{
+    return plants.reading[plant];
+}
+
+float bridge_sim_heater(uint32_t plant)
+{
+    return sim_channel_value(&heater_ch[plant]);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "plant_bank.h"
+
+// Portable part of the ESP-NOW bridge (bridge1.c): a bank of thermal plants
+// (plant_bank.h) and the frame handling, with all I/O going through
+// sim_transport.h. The firmware and the Linux sim_bridge process both drive
+// it the same way:
+//   bridge_sim_init(), then bridge_sim_tick() every BRIDGE_SIM_TICK_MS, with
+//   bridge_sim_on_receive() as the transport receive callback.
+// Plant i reports on SIM_PLANT_CHANNEL(i, SIM_CHANNEL_TEMPERATURE) and takes
+// commands on SIM_PLANT_CHANNEL(i, SIM_CHANNEL_HEATER).
+
+#define BRIDGE_SIM_TICK_MS 50      // 20Hz simulation rate
+
+// Simulate `plant_count` plants (1..PLANT_BANK_MAX) with default parameters
+void bridge_sim_init(uint32_t plant_count);
+
+// Built-in model parameters (plant_bank.h)
+void bridge_sim_set_params(uint32_t plant, const plant_params_t *params);
+
+// Simulate every plant with the named plug-in model (plant_model.h), stepped
+// once per tick; NULL restores the built-in model. False if the name is
+// unknown or the instances cannot be allocated.
+bool bridge_sim_set_model(const char *name, plant_integrator_t integrator);
+
+// Physics computed outside the bank (e.g. WASM plants, wasm_plant.h): every
+// tick, plant i's new temperature is step(arg, i, dt, heater command).
+// Sensor noise is still added by the bank. NULL restores the bank physics.
+typedef float (*bridge_sim_external_fn)(void *arg, uint32_t plant, float dt, float u);
+void bridge_sim_set_external(bridge_sim_external_fn step, void *arg);
+
+// Advance every plant one tick and send the sensor batch(es) to the controller
+void bridge_sim_tick(void);
+
+// Advance every plant one tick without sending anything. Used directly by the
+// lockstep runner, which owns the clock.
+void bridge_sim_advance(void);
+
+// Transport receive callback: applies heater commands from the controller
+void bridge_sim_on_receive(const uint8_t *data, int len);
+
+// Apply a heater command (clamped to 0..1), as if received from the controller
+void bridge_sim_set_heater(uint32_t plant, float value);
+
+uint32_t bridge_sim_plant_count(void);
+float bridge_sim_temperature(uint32_t plant);
+float bridge_sim_reading(uint32_t plant); // Noisy sensor value of the last tick
+float bridge_sim_heater(uint32_t plant);
@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "plant_bank.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_random.h"
+#endif
+
+// Generate random float in range [min, max]
+static float random_float(float min, float max)
+{
+#ifdef ESP_PLATFORM
+    uint32_t rand_val = esp_random();
+    float normalized = (float)rand_val / (float)UINT32_MAX;
+#else
+    float normalized = (float)random() / (float)RAND_MAX;
+#endif
+    return min + normalized * (max - min);
+}
+
+void plant_bank_init(plant_bank_t *bank, uint32_t count)
+{
+    const plant_params_t defaults = PLANT_PARAMS_DEFAULT;
+
+    bank->count = count > PLANT_BANK_MAX ? PLANT_BANK_MAX : count;
+    bank->models = NULL;
+    for (uint32_t i = 0; i < PLANT_BANK_MAX; i++)
+    {
+        plant_bank_set_params(bank, i, &defaults);
+        bank->temp[i] = defaults.ambient;
+        bank->reading[i] = defaults.ambient;
+        bank->heater[i] = 0.0f;
+    }
+}
+
+void plant_bank_set_params(plant_bank_t *bank, uint32_t plant, const plant_params_t *params)
+{
+    bank->ambient[plant] = params->ambient;
+    bank->heating_rate[plant] = params->heating_rate;
+    bank->cooling_rate[plant] = params->cooling_rate;
+    bank->thermal_mass[plant] = params->thermal_mass;
+}
+
+bool plant_bank_set_model(plant_bank_t *bank, const plant_model_t *model,
+                          plant_integrator_t integrator, float dt)
+{
+    free(bank->models);
+    bank->models = NULL;
+    if (!model)
+        return true;
+
+    bank->models = malloc(bank->count * sizeof(plant_t));
+    if (!bank->models)
+        return false;
+    bank->dt = dt;
+    for (uint32_t i = 0; i < bank->count; i++)
+    {
+        plant_init(&bank->models[i], model, integrator);
+        bank->temp[i] = plant_temperature(&bank->models[i]);
+        bank->reading[i] = bank->temp[i];
+    }
+    return true;
+}
+
+// Plug-in models: not vectorizable, one instance at a time
+static void integrate_models(plant_bank_t *bank)
+{
+    for (uint32_t i = 0; i < bank->count; i++)
+    {
+        plant_step(&bank->models[i], bank->dt, bank->heater[i]);
+        bank->temp[i] = plant_temperature(&bank->models[i]);
+    }
+}
+
+void plant_bank_integrate(plant_bank_t *bank)
+{
+    if (bank->models)
+    {
+        integrate_models(bank);
+        return;
+    }
+
+    const uint32_t n = bank->count;
+    float *restrict temp = bank->temp;
+    const float *restrict heater = bank->heater;
+    const float *restrict ambient = bank->ambient;
+    const float *restrict heating_rate = bank->heating_rate;
+    const float *restrict cooling_rate = bank->cooling_rate;
+    const float *restrict thermal_mass = bank->thermal_mass;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        // Newton's Law of Cooling
+        // Energy In: Heater Power
+        float energy_in = heater[i] * heating_rate[i];
+        // Energy Out: Difference between object and room temp
+        float energy_out = (temp[i] - ambient[i]) * cooling_rate[i];
+
+        // Apply Thermal Mass (Smoothing/Lag)
+        float target_next_temp = temp[i] + energy_in - energy_out;
+        temp[i] = temp[i] * thermal_mass[i] + target_next_temp * (1.0f - thermal_mass[i]);
+    }
+}
+
+void plant_bank_sample(plant_bank_t *bank)
+{
+    // Add sensor noise for realistic PID testing. Kept out of the physics
+    // loop: the RNG is a call and would stop it from vectorizing.
+    for (uint32_t i = 0; i < bank->count; i++)
+    {
+        bank->reading[i] = bank->temp[i] + random_float(-SENSOR_NOISE, SENSOR_NOISE);
+    }
+}
+
+void plant_bank_step(plant_bank_t *bank)
+{
+    plant_bank_integrate(bank);
+    plant_bank_sample(bank);
+}
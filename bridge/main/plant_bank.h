@@ -0,0 +1,76 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "plant_model.h"
+
+// Batched thermal plant engine: N independent heaters held as a structure of
+// arrays, so one tick is a single branch-free loop over contiguous floats that
+// the compiler can vectorize (SSE/NEON on the host build). Each plant has its
+// own Newton-cooling parameters; sensor noise is added per plant afterwards.
+//
+// Any other plant model (plant_model.h) can replace the built-in loop for the
+// whole bank: each plant then becomes a model instance, stepped one by one
+// through the same temp[] / heater[] / reading[] arrays.
+
+// --- DEFAULT PHYSICS CONSTANTS (from sim.py) ---
+#define AMBIENT_TEMP      25.0f    // Room temp (C)
+#define MAX_HEATER_TEMP   200.0f   // Max temp if heater stays on forever
+#define HEATING_RATE      0.8f     // How fast it gains heat (deg/tick)
+#define COOLING_RATE      0.02f    // How fast it loses heat to environment
+#define THERMAL_MASS      0.95f    // Inertia (Higher = Slower/Smoother changes)
+#define SENSOR_NOISE      0.3f     // Sensor noise amplitude (+/- C)
+
+// Plant ids travel in 8-bit channel ids (see SIM_PLANT_CHANNEL)
+#define PLANT_BANK_MAX    64
+
+#define PLANT_BANK_ALIGN  __attribute__((aligned(16)))
+
+typedef struct {
+    float ambient;       // Room temp (C)
+    float heating_rate;  // deg/tick at full heater power
+    float cooling_rate;  // Fraction of the excess over ambient lost per tick
+    float thermal_mass;  // 0..1, higher = slower response
+} plant_params_t;
+
+#define PLANT_PARAMS_DEFAULT { AMBIENT_TEMP, HEATING_RATE, COOLING_RATE, THERMAL_MASS }
+
+typedef struct {
+    uint32_t count;
+
+    // State
+    PLANT_BANK_ALIGN float temp[PLANT_BANK_MAX];
+    PLANT_BANK_ALIGN float heater[PLANT_BANK_MAX];   // Input, 0.0 .. 1.0
+    PLANT_BANK_ALIGN float reading[PLANT_BANK_MAX];  // Output, temp + noise
+
+    // Parameters
+    PLANT_BANK_ALIGN float ambient[PLANT_BANK_MAX];
+    PLANT_BANK_ALIGN float heating_rate[PLANT_BANK_MAX];
+    PLANT_BANK_ALIGN float cooling_rate[PLANT_BANK_MAX];
+    PLANT_BANK_ALIGN float thermal_mass[PLANT_BANK_MAX];
+
+    // Plug-in model instances (count of them), NULL for the built-in loop
+    plant_t *models;
+    float dt; // Model step (s)
+} plant_bank_t;
+
+// `count` plants (clamped to PLANT_BANK_MAX) with default parameters, at
+// ambient temperature with the heater off, on the built-in model
+void plant_bank_init(plant_bank_t *bank, uint32_t count);
+
+// Step every plant with `model` (default parameters, at rest) every `dt`
+// seconds instead of the built-in loop; NULL goes back to the built-in one.
+// False if the instances cannot be allocated.
+bool plant_bank_set_model(plant_bank_t *bank, const plant_model_t *model,
+                          plant_integrator_t integrator, float dt);
+
+// Built-in model parameters
+void plant_bank_set_params(plant_bank_t *bank, uint32_t plant, const plant_params_t *params);
+
+// Physics only: advance every plant one tick (the vectorized loop)
+void plant_bank_integrate(plant_bank_t *bank);
+
+// Sample every sensor: temp[] plus noise into reading[]
+void plant_bank_sample(plant_bank_t *bank);
+
+// One full tick: integrate, then sample
+void plant_bank_step(plant_bank_t *bank);
@@ -0,0 +1,216 @@
+#include <string.h>
+#include "plant_model.h"
+
+// ============================================================================
+// MODELS
+// ============================================================================
+
+// Defaults reproduce the original sim.py plant: heating 0.8 deg/tick and
+// cooling 0.02/tick through a 0.95 thermal mass at 50 ms ticks, i.e.
+// 0.8 C/s at full power and a 50 s time constant (65 C at full power).
+
+// dT/dt = heat_rate * u - loss_rate * (T - ambient)
+static void first_order_derivative(const float *x, const float *p, float u, float *dx)
+{
+    dx[0] = p[1] * u - p[2] * (x[0] - p[0]);
+}
+
+const plant_model_t plant_model_first_order = {
+    .name = "first_order",
+    .description = "lumped body, Newton cooling",
+    .n_states = 1,
+    .n_params = 3,
+    .param_names = {"ambient", "heat_rate", "loss_rate"},
+    .param_defaults = {25.0f, 0.8f, 0.02f},
+    .output_state = 0,
+    .delay_param = -1,
+    .derivative = first_order_derivative,
+};
+
+// Heater element (x0) coupled to the body (x1) the sensor sits on; the body
+// loses heat to ambient. Thermal capacities in J/K, resistances in K/W.
+//   C_h dTh/dt = P u - (Th - Tb) / R_hb
+//   C_b dTb/dt = (Th - Tb) / R_hb - (Tb - ambient) / R_ba
+static void second_order_derivative(const float *x, const float *p, float u, float *dx)
+{
+    float to_body = (x[0] - x[1]) / p[4];
+    float to_ambient = (x[1] - p[0]) / p[5];
+    dx[0] = (p[1] * u - to_body) / p[2];
+    dx[1] = (to_body - to_ambient) / p[3];
+}
+
+const plant_model_t plant_model_second_order = {
+    .name = "second_order",
+    .description = "heater element + body",
+    .n_states = 2,
+    .n_params = 6,
+    .param_names = {"ambient", "power", "c_heater", "c_body", "r_heater", "r_ambient"},
+    .param_defaults = {25.0f, 20.0f, 2.0f, 25.0f, 0.5f, 2.0f},
+    .output_state = 1,
+    .delay_param = -1,
+    .derivative = second_order_derivative,
+};
+
+// First order behind a dead time: heat reaches the body `delay` s after the
+// command (a sensor mounted away from the heater, a slow relay)
+const plant_model_t plant_model_delay = {
+    .name = "delay",
+    .description = "first order + transport delay",
+    .n_states = 1,
+    .n_params = 4,
+    .param_names = {"ambient", "heat_rate", "loss_rate", "delay"},
+    .param_defaults = {25.0f, 0.8f, 0.02f, 2.0f},
+    .output_state = 0,
+    .delay_param = 3,
+    .derivative = first_order_derivative,
+};
+
+static const plant_model_t *const models[] = {
+    &plant_model_first_order,
+    &plant_model_second_order,
+    &plant_model_delay,
+};
+
+#define MODEL_COUNT (sizeof(models) / sizeof(models[0]))
+
+const plant_model_t *plant_model_find(const char *name)
+{
+    for (uint32_t i = 0; i < MODEL_COUNT; i++)
+    {
+        if (strcmp(models[i]->name, name) == 0)
+            return models[i];
+    }
+    return NULL;
+}
+
+const plant_model_t *plant_model_at(uint32_t i)
+{
+    return i < MODEL_COUNT ? models[i] : NULL;
+}
+
+bool plant_integrator_parse(const char *name, plant_integrator_t *integrator)
+{
+    if (strcmp(name, "euler") == 0)
+        *integrator = PLANT_INTEGRATOR_EULER;
+    else if (strcmp(name, "rk4") == 0)
+        *integrator = PLANT_INTEGRATOR_RK4;
+    else
+        return false;
+    return true;
+}
+
+const char *plant_integrator_name(plant_integrator_t integrator)
+{
+    return integrator == PLANT_INTEGRATOR_RK4 ? "rk4" : "euler";
+}
+
+// ============================================================================
+// PLANT INSTANCES
+// ============================================================================
+
+void plant_init(plant_t *plant, const plant_model_t *model, plant_integrator_t integrator)
+{
+    memset(plant, 0, sizeof(*plant));
+    plant->model = model;
+    plant->integrator = integrator;
+    memcpy(plant->p, model->param_defaults, sizeof(plant->p));
+    plant_reset(plant);
+}
+
+bool plant_set_param(plant_t *plant, const char *name, float value)
+{
+    const plant_model_t *m = plant->model;
+    for (uint32_t i = 0; i < m->n_params; i++)
+    {
+        if (strcmp(m->param_names[i], name) == 0)
+        {
+            plant->p[i] = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void plant_reset(plant_t *plant)
+{
+    for (uint32_t i = 0; i < plant->model->n_states; i++)
+    {
+        plant->x[i] = plant->p[0];
+    }
+    memset(plant->delay_line, 0, sizeof(plant->delay_line));
+    plant->delay_head = 0;
+}
+
+// Record u and return the command from `delay` seconds ago. The line length
+// follows dt and the parameter, so both may change between steps.
+static float delayed_input(plant_t *plant, float dt, float u)
+{
+    float steps = plant->p[plant->model->delay_param] / dt + 0.5f;
+    uint32_t n = steps > PLANT_MODEL_DELAY_MAX ? PLANT_MODEL_DELAY_MAX
+                 : steps > 0.0f               ? (uint32_t)steps
+                                              : 0;
+    if (n == 0)
+        return u;
+
+    uint32_t head = plant->delay_head;
+    float out = plant->delay_line[(head + PLANT_MODEL_DELAY_MAX - n) % PLANT_MODEL_DELAY_MAX];
+    plant->delay_line[head] = u;
+    plant->delay_head = (head + 1) % PLANT_MODEL_DELAY_MAX;
+    return out;
+}
+
+// ============================================================================
+// INTEGRATORS
+// ============================================================================
+
+static void euler_step(const plant_model_t *m, float *x, const float *p, float dt, float u)
+{
+    float dx[PLANT_MODEL_MAX_STATES];
+    m->derivative(x, p, u, dx);
+    for (uint32_t i = 0; i < m->n_states; i++)
+    {
+        x[i] += dt * dx[i];
+    }
+}
+
+static void rk4_step(const plant_model_t *m, float *x, const float *p, float dt, float u)
+{
+    const uint32_t n = m->n_states;
+    float k1[PLANT_MODEL_MAX_STATES], k2[PLANT_MODEL_MAX_STATES];
+    float k3[PLANT_MODEL_MAX_STATES], k4[PLANT_MODEL_MAX_STATES];
+    float xt[PLANT_MODEL_MAX_STATES];
+
+    m->derivative(x, p, u, k1);
+    for (uint32_t i = 0; i < n; i++)
+        xt[i] = x[i] + 0.5f * dt * k1[i];
+    m->derivative(xt, p, u, k2);
+    for (uint32_t i = 0; i < n; i++)
+        xt[i] = x[i] + 0.5f * dt * k2[i];
+    m->derivative(xt, p, u, k3);
+    for (uint32_t i = 0; i < n; i++)
+        xt[i] = x[i] + dt * k3[i];
+    m->derivative(xt, p, u, k4);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        x[i] += dt / 6.0f * (k1[i] + 2.0f * (k2[i] + k3[i]) + k4[i]);
+    }
+}
+
+void plant_step(plant_t *plant, float dt, float u)
+{
+    const plant_model_t *m = plant->model;
+
+    if (m->delay_param >= 0)
+        u = delayed_input(plant, dt, u);
+
+    if (plant->integrator == PLANT_INTEGRATOR_RK4)
+        rk4_step(m, plant->x, plant->p, dt, u);
+    else
+        euler_step(m, plant->x, plant->p, dt, u);
+}
+
+float plant_temperature(const plant_t *plant)
+{
+    return plant->x[plant->model->output_state];
+}
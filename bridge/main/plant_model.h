@@ -0,0 +1,85 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Plant-model plug-ins: continuous-time thermal models behind one interface,
+// stepped by a fixed-step integrator and selectable by name at runtime.
+//
+// A model is a descriptor (plant_model_t): state and parameter counts,
+// parameter names and defaults, and its dynamics dx/dt = f(x, p, u), with u
+// the heater command (0..1). A plant (plant_t) is one instance: a model, its
+// state vector and parameters, plus an optional transport delay on u.
+//
+// The heater command is held constant across a step (zero-order hold, as the
+// bridge receives it). Explicit Euler at dt = 50 ms on "first_order" is the
+// same update as the built-in plant_bank.h loop; RK4 stays accurate for the
+// stiffer models and larger steps.
+//
+// Conventions every model follows:
+//   - parameter 0 is the ambient temperature (C), and the rest state is
+//     every state at ambient with the heater off
+//   - one state is the temperature the sensor sees (output_state)
+
+#define PLANT_MODEL_MAX_STATES 4
+#define PLANT_MODEL_MAX_PARAMS 8
+#define PLANT_MODEL_DELAY_MAX  256 // Delay-line samples: 12.8 s of dead time at 50 ms steps
+
+typedef enum {
+    PLANT_INTEGRATOR_EULER, // Explicit Euler: one derivative per step
+    PLANT_INTEGRATOR_RK4,   // Classic 4th-order Runge-Kutta: four per step
+} plant_integrator_t;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    uint32_t n_states;
+    uint32_t n_params;
+    const char *param_names[PLANT_MODEL_MAX_PARAMS];
+    float param_defaults[PLANT_MODEL_MAX_PARAMS];
+    uint32_t output_state; // State the sensor measures
+    int delay_param;       // Parameter holding the input dead time (s), or -1
+
+    // dx/dt for state x, parameters p, heater command u
+    void (*derivative)(const float *x, const float *p, float u, float *dx);
+} plant_model_t;
+
+typedef struct {
+    const plant_model_t *model;
+    plant_integrator_t integrator;
+    float x[PLANT_MODEL_MAX_STATES];
+    float p[PLANT_MODEL_MAX_PARAMS];
+
+    // Transport delay: ring of past heater commands
+    float delay_line[PLANT_MODEL_DELAY_MAX];
+    uint32_t delay_head;
+} plant_t;
+
+// --- BUILT-IN MODELS ---
+extern const plant_model_t plant_model_first_order;  // Lumped body, Newton cooling
+extern const plant_model_t plant_model_second_order; // Heater element + body
+extern const plant_model_t plant_model_delay;        // First order + dead time
+
+// Model by name, NULL if unknown
+const plant_model_t *plant_model_find(const char *name);
+
+// i-th built-in model, NULL past the last one (for listings)
+const plant_model_t *plant_model_at(uint32_t i);
+
+// "euler" or "rk4"
+bool plant_integrator_parse(const char *name, plant_integrator_t *integrator);
+const char *plant_integrator_name(plant_integrator_t integrator);
+
+// Default parameters, at rest
+void plant_init(plant_t *plant, const plant_model_t *model, plant_integrator_t integrator);
+
+// Set a parameter by name; false if the model has no such parameter
+bool plant_set_param(plant_t *plant, const char *name, float value);
+
+// Back to the rest state, parameters kept
+void plant_reset(plant_t *plant);
+
+// Advance dt seconds with heater command u held constant
+void plant_step(plant_t *plant, float dt, float u);
+
+// Temperature the sensor sees (before noise)
+float plant_temperature(const plant_t *plant);
@@ -0,0 +1,165 @@
+#include <stdatomic.h>
+#include "pwm_capture.h"
+#include "driver/gpio.h"
+#include "driver/mcpwm_cap.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define TAG "PWM_CAP"
+
+#define SLOTS      4 // Published windows in flight (see sim_state.c)
+#define MAX_PERIOD (UINT32_MAX / PWM_CAPTURE_MAX_WINDOW) // Ticks; longer gaps restart the window
+
+typedef struct {
+    uint32_t high_ticks;   // Sums over the window
+    uint32_t period_ticks;
+    uint32_t cycles;
+    int64_t timestamp_us;  // When the window closed
+} capture_window_t;
+
+static pwm_capture_config_t cfg;
+static uint32_t ticks_per_us = 1;
+
+// --- SPSC ring: written by the ISR only ---
+static _Atomic uint32_t published = 0; // Sequence number of the newest window
+static capture_window_t slots[SLOTS];
+
+// --- ISR decoder state ---
+static uint32_t rise_tick = 0;
+static uint32_t high_ticks = 0;
+static bool have_rise = false;
+static bool have_fall = false;
+static capture_window_t acc;
+static volatile uint32_t glitches = 0;
+
+static void IRAM_ATTR publish(void)
+{
+    uint32_t seq = atomic_load_explicit(&published, memory_order_relaxed) + 1;
+    acc.timestamp_us = esp_timer_get_time();
+    atomic_thread_fence(memory_order_release); // Previous publish before the slot (sim_state.c)
+    slots[seq % SLOTS] = acc;
+    atomic_store_explicit(&published, seq, memory_order_release);
+
+    acc.high_ticks = 0;
+    acc.period_ticks = 0;
+    acc.cycles = 0;
+}
+
+static bool IRAM_ATTR on_capture(mcpwm_cap_channel_handle_t chan,
+                                 const mcpwm_capture_event_data_t *edata, void *user_data)
+{
+    uint32_t t = edata->cap_value;
+
+    if (edata->cap_edge == MCPWM_CAP_EDGE_NEG)
+    {
+        if (have_rise && !have_fall)
+        {
+            high_ticks = t - rise_tick;
+            have_fall = true;
+        }
+        return false;
+    }
+
+    // A rising edge closes the cycle that started at the previous one
+    if (have_rise)
+    {
+        uint32_t period = t - rise_tick; // Wraps correctly
+        if (!have_fall || period > MAX_PERIOD)
+        {
+            // Missed edge, or the PWM stopped for a while: restart the window
+            glitches++;
+            acc.high_ticks = 0;
+            acc.period_ticks = 0;
+            acc.cycles = 0;
+        }
+        else
+        {
+            acc.high_ticks += high_ticks;
+            acc.period_ticks += period;
+            if (++acc.cycles == cfg.window_cycles)
+                publish();
+        }
+    }
+    rise_tick = t;
+    have_rise = true;
+    have_fall = false;
+    return false;
+}
+
+bool pwm_capture_start(const pwm_capture_config_t *config)
+{
+    cfg = *config;
+    if (cfg.window_cycles < 1 || cfg.window_cycles > PWM_CAPTURE_MAX_WINDOW)
+    {
+        ESP_LOGE(TAG, "Window of %lu cycles out of range", (unsigned long)cfg.window_cycles);
+        return false;
+    }
+
+    mcpwm_cap_timer_handle_t timer = NULL;
+    mcpwm_capture_timer_config_t timer_cfg = {
+        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
+        .group_id = 0,
+    };
+    ESP_ERROR_CHECK(mcpwm_new_capture_timer(&timer_cfg, &timer));
+
+    mcpwm_cap_channel_handle_t chan = NULL;
+    mcpwm_capture_channel_config_t chan_cfg = {
+        .gpio_num = cfg.gpio,
+        .prescale = 1,
+        .flags.pos_edge = true,
+        .flags.neg_edge = true,
+    };
+    ESP_ERROR_CHECK(mcpwm_new_capture_channel(timer, &chan_cfg, &chan));
+
+    uint32_t resolution_hz = 0;
+    ESP_ERROR_CHECK(mcpwm_capture_timer_get_resolution(timer, &resolution_hz));
+    ticks_per_us = resolution_hz / 1000000 ? resolution_hz / 1000000 : 1;
+
+    mcpwm_capture_event_callbacks_t cbs = {
+        .on_cap = on_capture,
+    };
+    ESP_ERROR_CHECK(mcpwm_capture_channel_register_event_callbacks(chan, &cbs, NULL));
+    ESP_ERROR_CHECK(mcpwm_capture_channel_enable(chan));
+    ESP_ERROR_CHECK(mcpwm_capture_timer_enable(timer));
+    ESP_ERROR_CHECK(mcpwm_capture_timer_start(timer));
+
+    ESP_LOGI(TAG, "Capturing on GPIO %d at %lu Hz, %lu-cycle windows", cfg.gpio,
+             (unsigned long)resolution_hz, (unsigned long)cfg.window_cycles);
+    return true;
+}
+
+pwm_capture_reading_t pwm_capture_read(void)
+{
+    pwm_capture_reading_t r = {0};
+    capture_window_t w;
+    uint32_t seq = atomic_load_explicit(&published, memory_order_acquire);
+
+    while (1)
+    {
+        w = slots[seq % SLOTS];
+        atomic_thread_fence(memory_order_acquire);
+
+        // Intact unless the ISR lapped the ring while we copied
+        uint32_t now = atomic_load_explicit(&published, memory_order_relaxed);
+        if (now - seq < SLOTS - 1)
+            break;
+        seq = now;
+    }
+    r.windows = seq;
+
+    if (seq == 0 || esp_timer_get_time() - w.timestamp_us > (int64_t)cfg.stale_us)
+    {
+        r.duty = gpio_get_level(cfg.gpio) ? 1.0f : 0.0f;
+        r.stale = true;
+        return r;
+    }
+    r.duty = (float)w.high_ticks / (float)w.period_ticks;
+    r.period_us = (float)w.period_ticks / (float)(w.cycles * ticks_per_us);
+    return r;
+}
+
+uint32_t pwm_capture_glitches(void)
+{
+    return glitches;
+}
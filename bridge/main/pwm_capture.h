@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Heater PWM decoding on an MCPWM capture channel.
+//
+// The capture ISR timestamps both edges at the capture timer resolution
+// (APB clock, 12.5 ns on the ESP32), measures every period and high time,
+// and sums them over a window of PWM cycles with integer adds only. Each
+// completed window is handed to the physics task through a lock-free
+// single-producer/single-consumer slot ring (same scheme as sim_state.h):
+// the ISR never waits, the reader never sees a torn window.
+//
+// A constant level (0 % or 100 % duty) has no edges: once no window has
+// completed for stale_us, the reading falls back to the pin level.
+
+#define PWM_CAPTURE_MAX_WINDOW 64 // Cycles per window; bounds the 32-bit sums
+
+typedef struct {
+    int gpio;
+    uint32_t window_cycles; // PWM periods averaged per reading, 1..PWM_CAPTURE_MAX_WINDOW
+    uint32_t stale_us;      // Longer without a window: duty follows the pin level
+} pwm_capture_config_t;
+
+typedef struct {
+    float duty;         // High time / period over the last window, 0..1
+    float period_us;    // Mean PWM period over that window, 0 when stale
+    uint32_t windows;   // Windows completed so far
+    bool stale;         // No recent window: duty is the static pin level
+} pwm_capture_reading_t;
+
+bool pwm_capture_start(const pwm_capture_config_t *config);
+
+// Latest duty. Lock-free; call from the consumer task.
+pwm_capture_reading_t pwm_capture_read(void);
+
+// Cycles dropped for a missing edge or a period too long to sum
+uint32_t pwm_capture_glitches(void);
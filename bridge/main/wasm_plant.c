@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wasm_plant.h"
+#include "esp_log.h"
+
+#define TAG "WASM_PLANT"
+
+// ============================================================================
+// PLANT NATIVES
+// ============================================================================
+
+// Container address of the caller's I/O window, 0 if it has none
+static uint32_t host_plant_window(wasm_exec_env_t exec_env)
+{
+    wasm_plant_t *p = wasm_runtime_get_custom_data(wasm_runtime_get_module_inst(exec_env));
+    return p ? p->io_app : 0;
+}
+
+static void host_plant_log(wasm_exec_env_t exec_env, const char *msg)
+{
+    wasm_plant_t *p = wasm_runtime_get_custom_data(wasm_runtime_get_module_inst(exec_env));
+    ESP_LOGI(TAG, "[%s] %s", p ? p->name : "?", msg);
+}
+
+static NativeSymbol plant_symbols[] = {
+    {"host_plant_window", host_plant_window, "()i", NULL},
+    {"host_plant_log", host_plant_log, "($)", NULL},
+};
+
+bool wasm_plant_register_natives(void)
+{
+    return wasm_runtime_register_natives("env", plant_symbols,
+                                         sizeof(plant_symbols) / sizeof(NativeSymbol));
+}
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+wasm_module_t wasm_plant_load(const char *path, uint8_t **buffer)
+{
+    char error_buf[128];
+    *buffer = NULL;
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *image = size > 0 ? malloc(size) : NULL;
+    if (!image || fread(image, 1, size, f) != (size_t)size)
+    {
+        ESP_LOGE(TAG, "Cannot read %s", path);
+        fclose(f);
+        free(image);
+        return NULL;
+    }
+    fclose(f);
+
+    wasm_module_t module = wasm_runtime_load(image, (uint32_t)size, error_buf, sizeof(error_buf));
+    if (!module)
+    {
+        ESP_LOGE(TAG, "%s: load failed: %s", path, error_buf);
+        free(image);
+        return NULL;
+    }
+    *buffer = image;
+    return module;
+}
+
+// ============================================================================
+// INSTANCES
+// ============================================================================
+
+bool wasm_plant_create(wasm_plant_t *p, wasm_module_t module, const char *name,
+                       const float *params, uint32_t param_count)
+{
+    char error_buf[128];
+
+    memset(p, 0, sizeof(*p));
+    p->name = name;
+    p->module_inst = wasm_runtime_instantiate(module, WASM_PLANT_STACK_SIZE, WASM_PLANT_HEAP_SIZE,
+                                              error_buf, sizeof(error_buf));
+    if (!p->module_inst)
+    {
+        ESP_LOGE(TAG, "%s: instantiation failed: %s", name, error_buf);
+        return false;
+    }
+
+    p->exec_env = wasm_runtime_create_exec_env(p->module_inst, WASM_PLANT_EXEC_STACK_SIZE);
+    p->step_func = wasm_runtime_lookup_function(p->module_inst, "plant_step");
+    p->io_app = (uint32_t)wasm_runtime_module_malloc(p->module_inst, sizeof(plant_io_t),
+                                                     (void **)&p->io);
+    if (!p->exec_env || !p->step_func || !p->io)
+    {
+        ESP_LOGE(TAG, "%s: %s", name, !p->step_func ? "no plant_step export" : "out of memory");
+        goto fail;
+    }
+
+    memset(p->io, 0, sizeof(plant_io_t));
+    if (param_count > PLANT_IO_PARAMS)
+        param_count = PLANT_IO_PARAMS;
+    if (params)
+    {
+        memcpy(p->io->params, params, param_count * sizeof(float));
+        p->io->param_count = param_count;
+    }
+    wasm_runtime_set_custom_data(p->module_inst, p); // For the natives
+
+    wasm_function_inst_t init_func = wasm_runtime_lookup_function(p->module_inst, "init");
+    if (init_func && !wasm_runtime_call_wasm(p->exec_env, init_func, 0, NULL))
+    {
+        const char *exception = wasm_runtime_get_exception(p->module_inst);
+        ESP_LOGE(TAG, "%s: init failed: %s", name, exception ? exception : "unknown");
+        goto fail;
+    }
+    return true;
+
+fail:
+    wasm_plant_destroy(p);
+    return false;
+}
+
+void wasm_plant_destroy(wasm_plant_t *p)
+{
+    if (p->exec_env)
+        wasm_runtime_destroy_exec_env(p->exec_env);
+    if (p->module_inst)
+        wasm_runtime_deinstantiate(p->module_inst);
+    memset(p, 0, sizeof(*p));
+}
+
+wasm_plant_t *wasm_plant_create_array(wasm_module_t module, const char *name, uint32_t count)
+{
+    wasm_plant_t *plants = calloc(count, sizeof(wasm_plant_t));
+    if (!plants)
+    {
+        ESP_LOGE(TAG, "%s: no memory for %lu plants", name, (unsigned long)count);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!wasm_plant_create(&plants[i], module, name, NULL, 0))
+        {
+            wasm_plant_destroy_array(plants, i);
+            return NULL;
+        }
+    }
+    return plants;
+}
+
+void wasm_plant_destroy_array(wasm_plant_t *plants, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        wasm_plant_destroy(&plants[i]);
+    }
+    free(plants);
+}
+
+// ============================================================================
+// STEPPING
+// ============================================================================
+
+float wasm_plant_step(wasm_plant_t *p, float dt, float u)
+{
+    uint32_t argv[2];
+    memcpy(&argv[0], &dt, sizeof(float)); // f32 argument cells
+    memcpy(&argv[1], &u, sizeof(float));
+
+    // A trapped step may have left a partial write: report the last good value
+    float last = p->io->outputs[PLANT_IO_TEMPERATURE];
+    p->steps++;
+    if (!wasm_runtime_call_wasm(p->exec_env, p->step_func, 2, argv))
+    {
+        if (p->traps++ == 0)
+        {
+            const char *exception = wasm_runtime_get_exception(p->module_inst);
+            ESP_LOGE(TAG, "%s: plant_step trapped: %s", p->name, exception ? exception : "unknown");
+        }
+        wasm_runtime_clear_exception(p->module_inst);
+        p->io->outputs[PLANT_IO_TEMPERATURE] = last;
+        return last;
+    }
+    return p->io->outputs[PLANT_IO_TEMPERATURE];
+}
+
+float wasm_plant_external_step(void *plants, uint32_t plant, float dt, float u)
+{
+    return wasm_plant_step(&((wasm_plant_t *)plants)[plant], dt, u);
+}
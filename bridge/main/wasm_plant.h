@@ -0,0 +1,57 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "plant_io.h"
+#include "wasm_export.h"
+
+// Plant models as WASM containers (bridge/plants/plant_abi.h), embedded the
+// same way the controller runs control laws: one instance per simulated
+// plant, init() once, then plant_step(dt, u) every tick with the result read
+// back from a shared I/O window (plant_io.h) in the instance's memory.
+//
+// A new plant is a new .wasm file; the bridge needs no rebuild. Plugged into
+// the bridge with bridge_sim_set_external(wasm_plant_external_step, plants).
+
+// Per-instance budgets: a plant keeps a few floats of state and its window
+#define WASM_PLANT_STACK_SIZE      (2 * 1024) // Instance's own exec env (start function)
+#define WASM_PLANT_HEAP_SIZE       (1 * 1024) // App heap, holds the I/O window
+#define WASM_PLANT_EXEC_STACK_SIZE (4 * 1024) // WASM operand/frame stack of the exec env
+
+typedef struct {
+    const char *name;
+    wasm_module_inst_t module_inst;
+    wasm_exec_env_t exec_env;
+    wasm_function_inst_t step_func; // Looked up once at creation
+
+    plant_io_t *io;  // Native address of the I/O window
+    uint32_t io_app; // Same window as a container address
+
+    uint32_t steps;
+    uint32_t traps; // Steps that trapped; the temperature then holds
+} wasm_plant_t;
+
+// Register the plant natives (host_plant_window, host_plant_log). Call once,
+// after wasm_runtime_full_init().
+bool wasm_plant_register_natives(void);
+
+// Read and load a plant module from a file. The returned buffer backs the
+// module and must be freed after wasm_runtime_unload.
+wasm_module_t wasm_plant_load(const char *path, uint8_t **buffer);
+
+// Instantiate `module`, set the first `param_count` parameters (params may
+// be NULL) and run init()
+bool wasm_plant_create(wasm_plant_t *p, wasm_module_t module, const char *name,
+                       const float *params, uint32_t param_count);
+
+void wasm_plant_destroy(wasm_plant_t *p);
+
+// `count` instances in a heap array, NULL (nothing left allocated) on failure
+wasm_plant_t *wasm_plant_create_array(wasm_module_t module, const char *name, uint32_t count);
+void wasm_plant_destroy_array(wasm_plant_t *plants, uint32_t count);
+
+// One plant_step(). Returns the sensor temperature; after a trap, the last
+// good one.
+float wasm_plant_step(wasm_plant_t *p, float dt, float u);
+
+// Adapter for bridge_sim_set_external(): `plants` is the instance array
+float wasm_plant_external_step(void *plants, uint32_t plant, float dt, float u);
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Builds bridge plant models (plant_abi.h) into WASM containers, the same way
+# controller/containers/create_container.bash builds control laws.
+#
+#   ./create_plant.bash [plant.c]
+#
+# With no argument every .c file here is built. Output goes to
+# ../wasm_assets/<name>.wasm (and .aot when wamrc is installed).
+
+WASI_SDK_PATH="/opt/wasi-sdk"
+CC="${WASI_SDK_PATH}/bin/clang"
+OUTPUT_DIR="../wasm_assets"
+
+# AOT compiler from the WAMR release the bridge runs, see create_container.bash
+WAMRC="${WAMRC:-wamrc}"
+AOT_TARGET="${AOT_TARGET:-xtensa}"
+AOT_CPU="${AOT_CPU:-esp32}"
+
+mkdir -p "$OUTPUT_DIR"
+
+# Same flags as the size profile of create_container.bash: no libc and no
+# entry point (the bridge calls the init/plant_step exports and provides no
+# WASI), and __heap_base/__data_end exported so WAMR shrinks each instance's
+# 64 KB linear memory to data + stack. The bridge runs one per plant.
+CFLAGS="-O3 \
+    --target=wasm32-wasi \
+    -nostdlib \
+    -Wl,--no-entry \
+    -Wl,--gc-sections \
+    -Wl,--strip-all \
+    -Wl,--export=__heap_base \
+    -Wl,--export=__data_end \
+    -Wl,--initial-memory=65536 \
+    -Wl,--max-memory=65536 \
+    -z stack-size=1024 \
+    -Wl,--allow-undefined"
+
+compile_file() {
+    local input_file="$1"
+    local filename=$(basename -- "$input_file")
+    local name="${filename%.*}"
+    local output_file="$OUTPUT_DIR/$name.wasm"
+
+    if [ ! -x "$CC" ]; then
+        echo "Error: Compiler not found at $CC"
+        exit 1
+    fi
+
+    echo "Compiling $input_file to $output_file..."
+    if ! "$CC" $CFLAGS -o "$output_file" "$input_file"; then
+        echo "Failed to compile $input_file"
+        exit 1
+    fi
+
+    if command -v "$WAMRC" >/dev/null 2>&1; then
+        "$WAMRC" --target="$AOT_TARGET" --cpu="$AOT_CPU" -o "${output_file%.wasm}.aot" "$output_file" || exit 1
+    else
+        echo "Warning: $WAMRC not found, skipping AOT compilation of $output_file"
+    fi
+}
+
+if [ -n "$1" ]; then
+    compile_file "$1"
+else
+    for file in *.c; do
+        compile_file "$file"
+    done
+fi
+
+ls -lh "$OUTPUT_DIR"/*.wasm "$OUTPUT_DIR"/*.aot 2>/dev/null
+../../controller/containers/container_size_report.py "$OUTPUT_DIR"/*.wasm
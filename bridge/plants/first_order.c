@@ -0,0 +1,50 @@
+#include "plant_abi.h"
+
+// Lumped thermal body with Newton cooling, the same model as first_order in
+// bridge/main/plant_model.c:
+//   dT/dt = heat_rate * u - loss_rate * (T - ambient)
+// Each step is solved in closed form for the held u (with a libm-free
+// exponential), so it stays stable for any dt.
+
+#define AMBIENT   25.0f // C
+#define HEAT_RATE 0.8f  // C/s at full power
+#define LOSS_RATE 0.02f // 1/s
+
+static plant_io_t *io = 0;
+static float ambient, heat_rate, loss_rate;
+static float temp;
+
+PLANT_EXPORT(init)
+void init(void)
+{
+    io = host_plant_window();
+    ambient = plant_io_param(io, PLANT_IO_AMBIENT, AMBIENT);
+    heat_rate = plant_io_param(io, 1, HEAT_RATE);
+    loss_rate = plant_io_param(io, 2, LOSS_RATE);
+    temp = ambient;
+    if (io)
+    {
+        io->output_count = 1;
+        io->outputs[PLANT_IO_TEMPERATURE] = temp;
+    }
+}
+
+// e^-x for the small x of one step, without libm: (1 + x/16)^-16
+static float decay(float x)
+{
+    float y = 1.0f / (1.0f + x * (1.0f / 16.0f));
+    y *= y;
+    y *= y;
+    y *= y;
+    return y * y;
+}
+
+PLANT_EXPORT(plant_step)
+void plant_step(float dt, float u)
+{
+    // Relaxes towards the steady state of the held command
+    float steady = ambient + heat_rate * u / loss_rate;
+    temp = steady + (temp - steady) * decay(loss_rate * dt);
+    if (io)
+        io->outputs[PLANT_IO_TEMPERATURE] = temp;
+}
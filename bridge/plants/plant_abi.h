@@ -0,0 +1,20 @@
+#pragma once
+#include "plant_io.h"
+
+// Container ABI of bridge plant models.
+//
+// The bridge instantiates the module once per simulated plant, calls init()
+// and then plant_step(dt, u) every simulation tick, with dt in seconds and u
+// the heater command (0..1) held over the step. plant_step() writes the new
+// sensor temperature to outputs[PLANT_IO_TEMPERATURE] of the I/O window
+// (plant_io.h), fetched once with host_plant_window() in init(). It must
+// return promptly: the bridge steps every plant back to back each tick.
+//
+// init() is also where the plant reads its parameters: params[] holds the
+// host's overrides, so one module serves plants with different constants.
+
+#define PLANT_EXPORT(name) __attribute__((export_name(#name)))
+
+// Host natives (module "env")
+extern plant_io_t *host_plant_window(void); // NULL if the host has none
+extern void host_plant_log(const char *msg);
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdint.h>
+
+// Shared I/O window between the bridge and a plant container. Included by
+// both sides: the layout is identical in wasm32 and on the host
+// (little-endian, 4-byte fields only), like container_io.h on the
+// controller.
+//
+// The host allocates one window per plant instance in the container's
+// linear memory and may fill params[] before init(). The container writes
+// its outputs during plant_step(); the host reads them right after, so a
+// step costs one boundary crossing however many outputs the model has.
+
+#define PLANT_IO_PARAMS  8
+#define PLANT_IO_OUTPUTS 4
+
+#define PLANT_IO_AMBIENT     0 // params[]: ambient temperature (C); others per model
+#define PLANT_IO_TEMPERATURE 0 // outputs[]: temperature the sensor sees (C)
+
+typedef struct {
+    uint32_t param_count;            // Valid entries in params[], set by the host
+    uint32_t output_count;           // Valid entries in outputs[], set by the plant
+    float params[PLANT_IO_PARAMS];   // Overrides; the plant keeps its default past param_count
+    float outputs[PLANT_IO_OUTPUTS];
+} plant_io_t;
+
+// Parameter i, or `fallback` when the host did not set it
+static inline float plant_io_param(const plant_io_t *io, uint32_t i, float fallback)
+{
+    return io && i < io->param_count ? io->params[i] : fallback;
+}
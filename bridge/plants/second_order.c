@@ -0,0 +1,63 @@
+#include "plant_abi.h"
+
+// Heater element coupled to the body the sensor sits on, the same model as
+// second_order in bridge/main/plant_model.c, integrated with RK4:
+//   C_h dTh/dt = P u - (Th - Tb) / R_hb
+//   C_b dTb/dt = (Th - Tb) / R_hb - (Tb - ambient) / R_ba
+// outputs[1] reports the heater element temperature.
+
+#define AMBIENT   25.0f // C
+#define POWER     20.0f // W at full duty
+#define C_HEATER  2.0f  // J/K
+#define C_BODY    25.0f // J/K
+#define R_HEATER  0.5f  // K/W, element to body
+#define R_AMBIENT 2.0f  // K/W, body to ambient
+
+#define OUTPUT_HEATER_TEMP 1
+
+static plant_io_t *io = 0;
+static float p[6];
+static float th, tb;
+
+PLANT_EXPORT(init)
+void init(void)
+{
+    static const float defaults[6] = {AMBIENT, POWER, C_HEATER, C_BODY, R_HEATER, R_AMBIENT};
+
+    io = host_plant_window();
+    for (int i = 0; i < 6; i++)
+        p[i] = plant_io_param(io, i, defaults[i]);
+    th = tb = p[0];
+    if (io)
+    {
+        io->output_count = 2;
+        io->outputs[PLANT_IO_TEMPERATURE] = tb;
+        io->outputs[OUTPUT_HEATER_TEMP] = th;
+    }
+}
+
+static void derivative(float h, float b, float u, float *dh, float *db)
+{
+    float to_body = (h - b) / p[4];
+    *dh = (p[1] * u - to_body) / p[2];
+    *db = (to_body - (b - p[0]) / p[5]) / p[3];
+}
+
+PLANT_EXPORT(plant_step)
+void plant_step(float dt, float u)
+{
+    float h1, b1, h2, b2, h3, b3, h4, b4;
+
+    derivative(th, tb, u, &h1, &b1);
+    derivative(th + 0.5f * dt * h1, tb + 0.5f * dt * b1, u, &h2, &b2);
+    derivative(th + 0.5f * dt * h2, tb + 0.5f * dt * b2, u, &h3, &b3);
+    derivative(th + dt * h3, tb + dt * b3, u, &h4, &b4);
+    th += dt / 6.0f * (h1 + 2.0f * (h2 + h3) + h4);
+    tb += dt / 6.0f * (b1 + 2.0f * (b2 + b3) + b4);
+
+    if (io)
+    {
+        io->outputs[PLANT_IO_TEMPERATURE] = tb;
+        io->outputs[OUTPUT_HEATER_TEMP] = th;
+    }
+}
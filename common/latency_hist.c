@@ -0,0 +1,121 @@
+#include <string.h>
+#include "latency_hist.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define TAG "LATENCY"
+
+static latency_hist_t *registry[LATENCY_HIST_MAX];
+static uint32_t registered = 0;
+
+static uint32_t bucket_of(uint32_t latency_us)
+{
+    if (latency_us == 0)
+        return 0;
+    uint32_t b = 32 - __builtin_clz(latency_us); // floor(log2) + 1
+    return b < LATENCY_HIST_BUCKETS ? b : LATENCY_HIST_BUCKETS - 1;
+}
+
+// Lower bound of bucket b in us (the upper bound is that of b + 1)
+static uint32_t bucket_floor(uint32_t b)
+{
+    return b == 0 ? 0 : 1u << (b - 1);
+}
+
+void latency_hist_init(latency_hist_t *hist, const char *name)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->name = name;
+
+    for (uint32_t i = 0; i < registered; i++)
+    {
+        if (registry[i] == hist)
+            return;
+    }
+    if (registered < LATENCY_HIST_MAX)
+    {
+        registry[registered++] = hist;
+    }
+    else
+    {
+        ESP_LOGW(TAG, "%s: registry full, not included in dumps", name);
+    }
+}
+
+void latency_hist_record(latency_hist_t *hist, uint32_t latency_us)
+{
+    hist->buckets[bucket_of(latency_us)]++;
+    hist->total_us += latency_us;
+    if (latency_us > hist->max_us)
+        hist->max_us = latency_us;
+    hist->count++;
+}
+
+void latency_hist_record_since(latency_hist_t *hist, int64_t since_us)
+{
+    if (since_us <= 0)
+        return;
+    int64_t elapsed = esp_timer_get_time() - since_us;
+    latency_hist_record(hist, elapsed > 0 ? (uint32_t)elapsed : 0);
+}
+
+void latency_hist_reset(latency_hist_t *hist)
+{
+    latency_hist_init(hist, hist->name);
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t *hist, float p)
+{
+    uint32_t count = hist->count;
+    if (count == 0)
+        return 0;
+
+    uint32_t rank = (uint32_t)(p / 100.0f * count + 0.5f);
+    if (rank < 1)
+        rank = 1;
+
+    uint32_t seen = 0;
+    for (uint32_t b = 0; b < LATENCY_HIST_BUCKETS - 1; b++)
+    {
+        seen += hist->buckets[b];
+        if (seen >= rank)
+            return bucket_floor(b + 1);
+    }
+    return hist->max_us;
+}
+
+void latency_hist_dump(const latency_hist_t *hist)
+{
+    uint32_t count = hist->count;
+    uint32_t mean = count ? (uint32_t)(hist->total_us / count) : 0;
+
+    ESP_LOGI(TAG, "%s: n=%lu mean %lu us max %lu us | p50 < %lu us p99 < %lu us",
+             hist->name, (unsigned long)count, (unsigned long)mean,
+             (unsigned long)hist->max_us,
+             (unsigned long)latency_hist_percentile(hist, 50.0f),
+             (unsigned long)latency_hist_percentile(hist, 99.0f));
+
+    for (uint32_t b = 0; b < LATENCY_HIST_BUCKETS; b++)
+    {
+        if (hist->buckets[b] == 0)
+            continue;
+        if (b == LATENCY_HIST_BUCKETS - 1)
+        {
+            ESP_LOGI(TAG, "  [%7lu,    inf) us: %lu", (unsigned long)bucket_floor(b),
+                     (unsigned long)hist->buckets[b]);
+        }
+        else
+        {
+            ESP_LOGI(TAG, "  [%7lu, %7lu) us: %lu", (unsigned long)bucket_floor(b),
+                     (unsigned long)bucket_floor(b + 1), (unsigned long)hist->buckets[b]);
+        }
+    }
+}
+
+void latency_hist_dump_all(void)
+{
+    for (uint32_t i = 0; i < registered; i++)
+    {
+        latency_hist_dump(registry[i]);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+
+// Fixed-bucket latency histograms for the sense-to-actuate path.
+//
+// Bucket 0 counts 0 us; bucket b >= 1 counts [2^(b-1), 2^b) us; the last
+// bucket also takes everything above. Recording is a count-leading-zeros
+// and an increment: no locks, no allocation, safe from any task.
+//
+// Like sim_channel_t, each histogram has exactly ONE recorder. Any task may
+// read or dump it at any time; a read that races a record is off by at most
+// that one sample.
+
+#define LATENCY_HIST_BUCKETS 24   // Top bucket starts at 2^22 us (~4.2 s)
+#define LATENCY_HIST_MAX     16   // Histograms reachable via latency_hist_dump_all()
+
+typedef struct {
+    const char *name;
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+} latency_hist_t;
+
+// Clear `hist` and register it for latency_hist_dump_all()
+void latency_hist_init(latency_hist_t *hist, const char *name);
+
+void latency_hist_record(latency_hist_t *hist, uint32_t latency_us);
+
+// Record the time from `since_us` (an esp_timer_get_time() stamp) to now.
+// Stamps of 0 mean "never sampled" and are ignored.
+void latency_hist_record_since(latency_hist_t *hist, int64_t since_us);
+
+void latency_hist_reset(latency_hist_t *hist);
+
+// Upper bound (us) of the bucket holding the p-th percentile, 0 < p <= 100.
+// Returns 0 for an empty histogram.
+uint32_t latency_hist_percentile(const latency_hist_t *hist, float p);
+
+// Log the summary and every non-empty bucket
+void latency_hist_dump(const latency_hist_t *hist);
+void latency_hist_dump_all(void);
@@ -0,0 +1,55 @@
+#include <string.h>
+#include "sim_packet.h"
+
+void sim_batch_begin(sim_batch_t *batch, uint8_t device_id, uint32_t counter)
+{
+    sim_batch_header_t header = {
+        .magic = SIM_BATCH_MAGIC,
+        .version = SIM_BATCH_VERSION,
+        .device_id = device_id,
+        .count = 0,
+        .counter = counter,
+    };
+    memcpy(batch->buf, &header, sizeof(header));
+    batch->len = sizeof(header);
+}
+
+bool sim_batch_add(sim_batch_t *batch, uint8_t channel, float value, uint32_t timestamp_us)
+{
+    sim_batch_header_t *header = (sim_batch_header_t *)batch->buf;
+    if (batch->len + sizeof(sim_batch_sample_t) > SIM_BATCH_MAX_LEN)
+    {
+        return false;
+    }
+
+    sim_batch_sample_t sample = {
+        .channel = channel,
+        .value = value,
+        .timestamp_us = timestamp_us,
+    };
+    memcpy(batch->buf + batch->len, &sample, sizeof(sample));
+    batch->len += sizeof(sample);
+    header->count++;
+    return true;
+}
+
+bool sim_batch_parse(const uint8_t *data, int len, sim_batch_header_t *header)
+{
+    if (len < (int)sizeof(sim_batch_header_t) || data[0] != SIM_BATCH_MAGIC)
+    {
+        return false;
+    }
+
+    memcpy(header, data, sizeof(*header));
+    if (header->version != SIM_BATCH_VERSION)
+    {
+        return false;
+    }
+    return len >= (int)(sizeof(*header) + header->count * sizeof(sim_batch_sample_t));
+}
+
+void sim_batch_get(const uint8_t *data, uint8_t index, sim_batch_sample_t *sample)
+{
+    memcpy(sample, data + sizeof(sim_batch_header_t) + index * sizeof(sim_batch_sample_t),
+           sizeof(*sample));
+}
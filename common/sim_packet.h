@@ -0,0 +1,82 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Batched multi-channel wire format for ESP-NOW (and the host transports).
+// One frame carries up to SIM_BATCH_MAX_SAMPLES samples, each with its own
+// channel id and timestamp, instead of one float per frame (SimPacket).
+//
+//   header  : magic, version, device_id, count, counter      (8 bytes)
+//   samples : count x { channel, value, timestamp_us }       (9 bytes each)
+//
+// All fields are little endian (native on ESP32 and x86/ARM hosts).
+// Receivers still accept legacy SimPacket frames; they are 10 bytes long and
+// never start with SIM_BATCH_MAGIC.
+
+#define SIM_BATCH_MAGIC        0xB5
+#define SIM_BATCH_VERSION      1
+#define SIM_BATCH_MAX_LEN      250 // ESP_NOW_MAX_DATA_LEN
+#define SIM_BATCH_MAX_SAMPLES  ((SIM_BATCH_MAX_LEN - sizeof(sim_batch_header_t)) / sizeof(sim_batch_sample_t))
+
+// Device ids (same meaning as SimPacket.device_id)
+#define SIM_DEVICE_BRIDGE      0
+#define SIM_DEVICE_CONTROLLER  1
+
+// Channel ids. Sensors flow bridge -> controller, actuators the other way.
+// Rigs with more signals extend this list.
+enum {
+    SIM_CHANNEL_TEMPERATURE = 1, // Sensor, degrees C
+    SIM_CHANNEL_HEATER      = 2, // Actuator, 0.0 (OFF) to 1.0 (ON)
+};
+
+// Rigs with several plants (one bridge emulating many heaters) put the plant
+// index in the upper six bits of the channel id. Plant 0 keeps the plain ids
+// above, so single-plant peers interoperate unchanged.
+#define SIM_PLANT_CHANNEL(plant, kind) ((uint8_t)(((plant) << 2) | (kind)))
+#define SIM_CHANNEL_KIND(channel)      ((channel) & 0x3)
+#define SIM_CHANNEL_PLANT(channel)     ((channel) >> 2)
+
+typedef struct __attribute__((packed)) {
+    uint8_t  magic;        // SIM_BATCH_MAGIC
+    uint8_t  version;      // SIM_BATCH_VERSION
+    uint8_t  device_id;    // Sender
+    uint8_t  count;        // Samples in this frame
+    uint32_t counter;      // Frame sequence number, to see if frames are dropped
+} sim_batch_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  channel;
+    float    value;
+    uint32_t timestamp_us; // Acquisition time on the sender's clock (low 32 bits)
+} sim_batch_sample_t;
+
+typedef struct {
+    uint8_t buf[SIM_BATCH_MAX_LEN];
+    size_t  len;
+} sim_batch_t;
+
+// ============================================================================
+// ENCODE
+// ============================================================================
+
+void sim_batch_begin(sim_batch_t *batch, uint8_t device_id, uint32_t counter);
+
+// Append a sample. Returns false (and leaves the frame unchanged) when full.
+bool sim_batch_add(sim_batch_t *batch, uint8_t channel, float value, uint32_t timestamp_us);
+
+static inline uint8_t sim_batch_count(const sim_batch_t *batch)
+{
+    return ((const sim_batch_header_t *)batch->buf)->count;
+}
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+// Validate a received frame and copy out its header. Returns false for
+// legacy SimPacket frames, unknown versions and truncated frames.
+bool sim_batch_parse(const uint8_t *data, int len, sim_batch_header_t *header);
+
+// Copy out sample `index` of a frame accepted by sim_batch_parse()
+void sim_batch_get(const uint8_t *data, uint8_t index, sim_batch_sample_t *sample);
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include "sim_pipeline.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#endif
+
+#define TAG "PIPELINE"
+
+void sim_stage_init(sim_stage_t *stage, const char *name, uint32_t period_us)
+{
+    snprintf(stage->name, sizeof(stage->name), "%s jitter", name);
+    stage->period_us = period_us;
+    stage->last_us = 0;
+    latency_hist_init(&stage->jitter, stage->name);
+}
+
+void sim_stage_activate(sim_stage_t *stage)
+{
+    int64_t now = esp_timer_get_time();
+    if (stage->last_us)
+    {
+        int64_t off = (now - stage->last_us) - stage->period_us;
+        latency_hist_record(&stage->jitter, (uint32_t)(off < 0 ? -off : off));
+    }
+    stage->last_us = now;
+}
+
+void sim_stage_report(const sim_stage_t *stage)
+{
+    const latency_hist_t *h = &stage->jitter;
+    uint32_t mean = h->count ? (uint32_t)(h->total_us / h->count) : 0;
+    ESP_LOGI(TAG, "%s: %lu intervals of %lu us | mean %lu us, p99 < %lu us, max %lu us",
+             stage->name, (unsigned long)h->count, (unsigned long)stage->period_us,
+             (unsigned long)mean, (unsigned long)latency_hist_percentile(h, 99.0f),
+             (unsigned long)h->max_us);
+}
+
+#ifdef ESP_PLATFORM
+void sim_pipeline_pthread_cfg(const char *name, uint32_t stack_size, int prio, int core)
+{
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.thread_name = name;
+    cfg.stack_size = stack_size;
+    cfg.prio = prio;
+    cfg.pin_to_core = core;
+    esp_pthread_set_cfg(&cfg);
+}
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include "latency_hist.h"
+
+// Dual-core pipeline: where every task of the bridge and controller firmware
+// runs, and at what priority.
+//
+//   SIM_CORE_IO       Wi-Fi / ESP-NOW (the IDF pins its tasks there by
+//                     default), acquisition, actuator frames, tracing,
+//                     housekeeping
+//   SIM_CORE_CONTROL  Container execution on the controller, the plant
+//                     simulation on the bridge, and nothing else, so radio
+//                     bursts never land on the core running a control law
+//
+// Priorities are rate monotonic within each core: the shorter a stage's
+// period, the higher its priority. The IDF's own tasks (Wi-Fi, esp_timer)
+// sit far above all of these.
+//
+// Stages hand data across the cores lock-free: latest values through
+// sim_channel_t (sim_state.h), streams through sim_ring_t (sim_ring.h).
+// Each periodic stage measures its activation jitter (sim_stage_t), dumped
+// with the latency histograms.
+
+#define SIM_CORE_IO      0
+#define SIM_CORE_CONTROL 1
+
+// SIM_CORE_IO
+#define SIM_PRIO_ACQUIRE      6 // ADC DMA frames, ~25 ms (adc_acquire.h)
+#define SIM_PRIO_COMMS        4 // Actuator frames, per control step (>= every 100 ms)
+#define SIM_PRIO_HOUSEKEEPING 2 // Button poll, container updates, >= 500 ms
+#define SIM_PRIO_TRACE        1 // Trace drain: just above idle, never delays the rest
+
+// SIM_CORE_CONTROL
+#define SIM_PRIO_PLANT        6 // Bridge physics tick, 50 ms
+#define SIM_PRIO_CONTROL      5 // Container steps, 100 ms
+
+// Activation jitter of one periodic stage: how far each interval between
+// two activations is from the period. One activating task per stage; any
+// task may dump it.
+typedef struct {
+    char name[32];
+    uint32_t period_us;
+    int64_t last_us;        // Previous activation, 0 = none yet
+    latency_hist_t jitter;  // |interval - period| (us), in latency_hist_dump_all()
+} sim_stage_t;
+
+// Clear `stage` and register its histogram. `stage` must outlive the dumps.
+void sim_stage_init(sim_stage_t *stage, const char *name, uint32_t period_us);
+
+// Call at the start of every activation
+void sim_stage_activate(sim_stage_t *stage);
+
+// One line: activations, jitter mean, p99 and max
+void sim_stage_report(const sim_stage_t *stage);
+
+#ifdef ESP_PLATFORM
+// Stack, priority and core for the next pthread_create() of the calling task
+void sim_pipeline_pthread_cfg(const char *name, uint32_t stack_size, int prio, int core);
+#endif
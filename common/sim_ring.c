@@ -0,0 +1,52 @@
+#include <string.h>
+#include "sim_ring.h"
+
+bool sim_ring_init(sim_ring_t *ring, void *storage, uint32_t capacity, uint32_t record_size)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return false;
+    }
+    ring->mask = capacity - 1;
+    ring->record_size = record_size;
+    ring->records = storage;
+    ring->dropped = 0;
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_release);
+    return true;
+}
+
+bool sim_ring_push(sim_ring_t *ring, const void *record)
+{
+    // Only the producer moves head; tail is acquired so the consumer is done
+    // with the slot before we overwrite it
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail > ring->mask)
+    {
+        ring->dropped++;
+        return false;
+    }
+
+    memcpy(ring->records + (head & ring->mask) * ring->record_size, record, ring->record_size);
+
+    // Make the record visible before the new head
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool sim_ring_pop(sim_ring_t *ring, void *record)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail)
+    {
+        return false;
+    }
+
+    memcpy(record, ring->records + (tail & ring->mask) * ring->record_size, ring->record_size);
+
+    // Hand the slot back only once it is copied out
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Single-producer single-consumer ring of fixed-size records, the hand-off
+// between two pipeline stages running on different cores (sim_pipeline.h).
+//
+// Unlike sim_channel_t, which only keeps the latest value, every record
+// pushed reaches the consumer in order. Each index is written by one side
+// only, so neither side locks or spins; a push onto a full ring fails and
+// is counted instead of overwriting records the consumer has not seen.
+// Storage is the caller's: nothing is allocated.
+
+typedef struct {
+    _Atomic uint32_t head; // Next slot to write, producer only
+    _Atomic uint32_t tail; // Next slot to read, consumer only
+    uint32_t mask;         // Capacity - 1
+    uint32_t record_size;
+    uint8_t *records;
+    uint32_t dropped;      // Pushes refused because the ring was full
+} sim_ring_t;
+
+// Use `capacity` records of `record_size` bytes at `storage`. The capacity
+// must be a power of two. Returns false otherwise.
+bool sim_ring_init(sim_ring_t *ring, void *storage, uint32_t capacity, uint32_t record_size);
+
+// Producer: copy `record` in. Returns false, and counts a drop, if full.
+bool sim_ring_push(sim_ring_t *ring, const void *record);
+
+// Consumer: copy the oldest record out. Returns false if empty.
+bool sim_ring_pop(sim_ring_t *ring, void *record);
+
+// Records waiting; exact from either side, a snapshot from anywhere else
+static inline uint32_t sim_ring_count(sim_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+           atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
@@ -0,0 +1,47 @@
+#include <string.h>
+#include "sim_state.h"
+
+void sim_channel_init(sim_channel_t *ch, float initial_value)
+{
+    memset(ch->slots, 0, sizeof(ch->slots));
+    ch->slots[0].value = initial_value;
+    atomic_store_explicit(&ch->seq, 0, memory_order_release);
+}
+
+void sim_channel_publish(sim_channel_t *ch, float value, int64_t timestamp_us)
+{
+    // Only the writer modifies seq, so a relaxed load is enough
+    uint32_t seq = atomic_load_explicit(&ch->seq, memory_order_relaxed) + 1;
+    sim_sample_t *slot = &ch->slots[seq % SIM_STATE_SLOTS];
+
+    // A reader that sees any of the stores below must also see the previous
+    // publish when it re-checks seq, or it could miss being lapped
+    atomic_thread_fence(memory_order_release);
+    slot->value = value;
+    slot->seq = seq;
+    slot->timestamp_us = timestamp_us;
+
+    // Make the slot contents visible before the new sequence number
+    atomic_store_explicit(&ch->seq, seq, memory_order_release);
+}
+
+sim_sample_t sim_channel_read(sim_channel_t *ch)
+{
+    sim_sample_t sample;
+    uint32_t seq = atomic_load_explicit(&ch->seq, memory_order_acquire);
+
+    while (1)
+    {
+        sample = ch->slots[seq % SIM_STATE_SLOTS];
+        atomic_thread_fence(memory_order_acquire);
+
+        // While we copied slot `seq`, the writer may have filled slots up to
+        // `now + 1`. Ours is intact unless that range wrapped onto it.
+        uint32_t now = atomic_load_explicit(&ch->seq, memory_order_relaxed);
+        if (now - seq < SIM_STATE_SLOTS - 1)
+        {
+            return sample;
+        }
+        seq = now;
+    }
+}
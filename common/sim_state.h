@@ -0,0 +1,41 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Lock-free exchange of sensor values and actuator commands between tasks,
+// ISRs and the ESP-NOW receive callback.
+//
+// Each channel has exactly ONE writer (e.g. the ADC reader for the
+// temperature, the WASM native for the heater command) and any number of
+// readers. The writer fills the next slot of a small ring and then publishes
+// its sequence number; readers copy the published slot and re-check the
+// sequence. A reader only retries if the writer lapped the whole ring during
+// the copy, so neither side ever blocks, and a high-priority reader can never
+// spin on a preempted writer (an unfinished slot is never the published one).
+
+#define SIM_STATE_SLOTS 4
+
+typedef struct {
+    float    value;
+    uint32_t seq;          // Publish count, 0 = initial value (never written)
+    int64_t  timestamp_us; // Acquisition time given by the writer
+} sim_sample_t;
+
+typedef struct {
+    _Atomic uint32_t seq;  // Sequence number of the published slot
+    sim_sample_t slots[SIM_STATE_SLOTS];
+} sim_channel_t;
+
+// Set the value readers see before the first publish
+void sim_channel_init(sim_channel_t *ch, float initial_value);
+
+// Publish a new value. Single writer only; safe from ISRs.
+void sim_channel_publish(sim_channel_t *ch, float value, int64_t timestamp_us);
+
+// Consistent snapshot of the latest value
+sim_sample_t sim_channel_read(sim_channel_t *ch);
+
+static inline float sim_channel_value(sim_channel_t *ch)
+{
+    return sim_channel_read(ch).value;
+}
@@ -0,0 +1,180 @@
+#include <stdatomic.h>
+#include "sim_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sim_pipeline.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <pthread.h>
+#include <unistd.h>
+#define IRAM_ATTR
+#endif
+
+#define TAG "TRACE"
+
+#define RING_MASK (SIM_TRACE_RECORDS - 1)
+
+_Static_assert((SIM_TRACE_RECORDS & RING_MASK) == 0, "SIM_TRACE_RECORDS must be a power of two");
+_Static_assert(sizeof(sim_trace_record_t) == 16, "record layout is part of the wire format");
+
+// A slot's seq is 0 while a writer fills it and position + 1 once complete
+typedef struct {
+    _Atomic uint32_t seq;
+    uint32_t timestamp_us;
+    uint16_t event;
+    uint16_t channel;
+    float value;
+} trace_slot_t;
+
+static trace_slot_t ring[SIM_TRACE_RECORDS];
+static _Atomic uint32_t head = 0; // Next position to claim
+static uint32_t tail = 0;         // Next position to drain (drain task only)
+
+void IRAM_ATTR sim_trace(uint16_t event, uint16_t channel, float value)
+{
+    uint32_t pos = atomic_fetch_add_explicit(&head, 1, memory_order_relaxed);
+    trace_slot_t *slot = &ring[pos & RING_MASK];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->timestamp_us = (uint32_t)esp_timer_get_time();
+    slot->event = event;
+    slot->channel = channel;
+    slot->value = value;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+}
+
+uint32_t sim_trace_drain(sim_trace_record_t *out, uint32_t max, uint32_t *lost)
+{
+    uint32_t n = 0;
+    *lost = 0;
+
+    while (n < max)
+    {
+        trace_slot_t *slot = &ring[tail & RING_MASK];
+        uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        sim_trace_record_t rec = {
+            .seq = seq,
+            .timestamp_us = slot->timestamp_us,
+            .event = slot->event,
+            .channel = slot->channel,
+            .value = slot->value,
+        };
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t recheck = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+        if (seq == tail + 1 && recheck == seq)
+        {
+            out[n++] = rec;
+            tail++;
+        }
+        else if (seq != 0 && (int32_t)(seq - (tail + 1)) > 0)
+        {
+            // Lapped: everything older than one ring behind the writers is gone
+            uint32_t oldest = atomic_load_explicit(&head, memory_order_relaxed) - SIM_TRACE_RECORDS;
+            if ((int32_t)(oldest - tail) <= 0)
+                oldest = tail + 1;
+            *lost += oldest - tail;
+            tail = oldest;
+        }
+        else
+        {
+            break; // Not written yet, or a writer is mid-record
+        }
+    }
+    return n;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static void put_base64(FILE *out, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i += 3)
+    {
+        uint32_t left = len - i;
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (left > 1)
+            v |= (uint32_t)data[i + 1] << 8;
+        if (left > 2)
+            v |= data[i + 2];
+        fputc(b64[(v >> 18) & 63], out);
+        fputc(b64[(v >> 12) & 63], out);
+        fputc(left > 1 ? b64[(v >> 6) & 63] : '=', out);
+        fputc(left > 2 ? b64[v & 63] : '=', out);
+    }
+}
+
+void sim_trace_flush(FILE *out)
+{
+    sim_trace_record_t recs[SIM_TRACE_PER_LINE];
+    uint32_t lost;
+    uint32_t n;
+
+    while ((n = sim_trace_drain(recs, SIM_TRACE_PER_LINE, &lost)) > 0 || lost)
+    {
+        fprintf(out, "#TRACE %lu ", (unsigned long)lost);
+        put_base64(out, (const uint8_t *)recs, n * sizeof(sim_trace_record_t));
+        fputc('\n', out);
+    }
+    fflush(out);
+}
+
+static FILE *drain_out;
+static uint32_t drain_period_ms;
+
+#ifdef ESP_PLATFORM
+static void drain_task(void *arg)
+{
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(drain_period_ms));
+        sim_trace_flush(drain_out);
+    }
+}
+
+bool sim_trace_start_drain(FILE *out, uint32_t period_ms)
+{
+    drain_out = out;
+    drain_period_ms = period_ms;
+    // Just above idle: formatting and UART output never delay the control path
+    if (xTaskCreatePinnedToCore(drain_task, "trace_drain", 3072, NULL, SIM_PRIO_TRACE, NULL,
+                                SIM_CORE_IO) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        return false;
+    }
+    return true;
+}
+#else
+static void *drain_thread(void *arg)
+{
+    while (1)
+    {
+        usleep(drain_period_ms * 1000);
+        sim_trace_flush(drain_out);
+    }
+    return NULL;
+}
+
+bool sim_trace_start_drain(FILE *out, uint32_t period_ms)
+{
+    pthread_t t;
+    drain_out = out;
+    drain_period_ms = period_ms;
+    if (pthread_create(&t, NULL, drain_thread, NULL) != 0)
+    {
+        ESP_LOGE(TAG, "Failed to create drain thread");
+        return false;
+    }
+    pthread_detach(t);
+    return true;
+}
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Binary telemetry trace. Events are fixed 16-byte records in a RAM ring,
+// written lock-free from any task or ISR; nothing is formatted on the hot
+// path. A low-priority drain task emits them in bulk as base64 "#TRACE"
+// lines that can share the console with ESP_LOG output, and
+// common/trace_decode.py turns a captured log back into text or CSV.
+//
+// Writers claim a slot with one atomic increment, so any number of them may
+// trace concurrently. A writer that laps the drain overwrites the oldest
+// records; the drain reports how many it lost.
+
+#define SIM_TRACE_RECORDS 1024 // Power of two (16 KiB of RAM)
+#define SIM_TRACE_PER_LINE 16  // Records per "#TRACE" line
+
+// Event ids. trace_decode.py takes the names from this list: append only,
+// one "SIM_TRACE_<NAME> = <id>," per line.
+typedef enum {
+    SIM_TRACE_ADC_SAMPLE = 1,    // channel: raw ADC count, value: temperature (C)
+    SIM_TRACE_ADC_MV = 2,        // channel: ADC channel, value: calibrated mV
+    SIM_TRACE_HEATER_CMD = 3,    // channel: plant, value: heater command (0..1)
+    SIM_TRACE_PLANT_TEMP = 4,    // channel: plant, value: true temperature (C)
+    SIM_TRACE_PLANT_READING = 5, // channel: plant, value: sensor reading (C)
+    SIM_TRACE_DAC_OUT = 6,       // channel: DAC channel, value: DAC code
+    SIM_TRACE_FRAME_RX = 7,      // channel: sender device id, value: samples in frame
+    SIM_TRACE_PWM_PERIOD = 8,    // channel: 1 if stale (static level), value: PWM period (us)
+} sim_trace_event_t;
+
+// Wire layout of a record (little-endian, as emitted)
+typedef struct {
+    uint32_t seq;          // Trace position + 1; gaps mean lost records
+    uint32_t timestamp_us; // Low 32 bits of esp_timer_get_time() (wraps ~71 min)
+    uint16_t event;        // sim_trace_event_t
+    uint16_t channel;
+    float value;
+} sim_trace_record_t;
+
+// Record an event. Lock-free; safe from ISRs.
+void sim_trace(uint16_t event, uint16_t channel, float value);
+
+// Copy out up to `max` records not drained yet, oldest first. *lost is set to
+// the number overwritten before they could be drained. Single consumer.
+uint32_t sim_trace_drain(sim_trace_record_t *out, uint32_t max, uint32_t *lost);
+
+// Drain everything pending to `out` as "#TRACE <lost> <base64>" lines
+void sim_trace_flush(FILE *out);
+
+// Start a low-priority task (a thread on Linux) calling sim_trace_flush(out)
+// every period_ms
+bool sim_trace_start_drain(FILE *out, uint32_t period_ms);
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Point-to-point frame transport between the bridge and the controller.
+// Exactly one backend is linked into each build:
+//   ESP32: ESP-NOW to a fixed peer MAC (sim_transport_espnow.c)
+//   Linux: UDP datagrams to a fixed peer address (sim_transport_udp.c)
+// Frames are opaque here (see sim_packet.h) and at most SIM_TRANSPORT_MAX_LEN
+// bytes, the ESP-NOW payload limit.
+
+#define SIM_TRANSPORT_MAX_LEN 250
+
+// Called once per received frame, from the transport's own context (the
+// Wi-Fi task on ESP32, a receive thread on Linux). Must not block.
+typedef void (*sim_transport_recv_cb_t)(const uint8_t *data, int len);
+
+#ifdef ESP_PLATFORM
+// Bring up NVS, Wi-Fi (STA) and ESP-NOW, and register `peer_mac` as the
+// only peer.
+bool sim_transport_espnow_init(const uint8_t peer_mac[6], sim_transport_recv_cb_t on_receive);
+#else
+// Default ports of the Linux bridge/controller pair
+#define SIM_BRIDGE_UDP_PORT     47001
+#define SIM_CONTROLLER_UDP_PORT 47002
+
+// Bind a UDP socket to `local_port` on all interfaces and send to
+// `peer_host`:`peer_port` (numeric IPv4 address or host name).
+bool sim_transport_udp_init(uint16_t local_port, const char *peer_host, uint16_t peer_port,
+                            sim_transport_recv_cb_t on_receive);
+#endif
+
+// Send one frame to the peer. Returns false if the frame was not queued.
+bool sim_transport_send(const uint8_t *data, size_t len);
@@ -0,0 +1,73 @@
+#include <string.h>
+#include "sim_transport.h"
+#include "esp_log.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_now.h"
+#include "esp_wifi.h"
+#include "nvs_flash.h"
+
+#define TAG "TRANSPORT"
+
+static uint8_t peer[6];
+static sim_transport_recv_cb_t recv_cb = NULL;
+
+static void esp_now_wifi_init(void)
+{
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        nvs_flash_erase();
+        nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+    ESP_ERROR_CHECK(esp_wifi_start());
+}
+
+static void on_esp_now_recv(const esp_now_recv_info_t *esp_now_info, const uint8_t *data, int len)
+{
+    if (recv_cb)
+    {
+        recv_cb(data, len);
+    }
+}
+
+bool sim_transport_espnow_init(const uint8_t peer_mac[6], sim_transport_recv_cb_t on_receive)
+{
+    esp_now_wifi_init();
+    if (esp_now_init() != ESP_OK)
+    {
+        ESP_LOGE(TAG, "ESP-NOW Init Failed");
+        return false;
+    }
+
+    esp_now_peer_info_t peerInfo = {};
+    memcpy(peerInfo.peer_addr, peer_mac, 6);
+    peerInfo.channel = 0;
+    peerInfo.encrypt = false;
+    if (esp_now_add_peer(&peerInfo) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to add peer");
+        return false;
+    }
+    memcpy(peer, peer_mac, 6);
+
+    recv_cb = on_receive;
+    esp_now_register_recv_cb(on_esp_now_recv);
+    return true;
+}
+
+bool sim_transport_send(const uint8_t *data, size_t len)
+{
+    esp_err_t result = esp_now_send(peer, data, len);
+    if (result != ESP_OK)
+    {
+        ESP_LOGW(TAG, "ESP-NOW send failed: %s", esp_err_to_name(result));
+        return false;
+    }
+    return true;
+}
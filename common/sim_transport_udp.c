@@ -0,0 +1,109 @@
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "sim_transport.h"
+#include "esp_log.h"
+
+#define TAG "TRANSPORT"
+
+static int sock = -1;
+static struct sockaddr_in peer_addr;
+static sim_transport_recv_cb_t recv_cb = NULL;
+
+// Plays the role of the Wi-Fi task: one callback per datagram
+static void *receive_thread(void *arg)
+{
+    uint8_t buf[SIM_TRANSPORT_MAX_LEN];
+    while (1)
+    {
+        ssize_t len = recv(sock, buf, sizeof(buf), 0);
+        if (len < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            ESP_LOGE(TAG, "recv failed: %s", strerror(errno));
+            return NULL;
+        }
+        recv_cb(buf, (int)len);
+    }
+}
+
+static bool resolve_peer(const char *host, uint16_t port)
+{
+    struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_DGRAM};
+    struct addrinfo *res = NULL;
+    char service[8];
+
+    snprintf(service, sizeof(service), "%u", port);
+    int err = getaddrinfo(host, service, &hints, &res);
+    if (err != 0)
+    {
+        ESP_LOGE(TAG, "Cannot resolve %s: %s", host, gai_strerror(err));
+        return false;
+    }
+    memcpy(&peer_addr, res->ai_addr, sizeof(peer_addr));
+    freeaddrinfo(res);
+    return true;
+}
+
+bool sim_transport_udp_init(uint16_t local_port, const char *peer_host, uint16_t peer_port,
+                            sim_transport_recv_cb_t on_receive)
+{
+    if (!resolve_peer(peer_host, peer_port))
+    {
+        return false;
+    }
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        ESP_LOGE(TAG, "socket failed: %s", strerror(errno));
+        return false;
+    }
+
+    struct sockaddr_in local = {
+        .sin_family = AF_INET,
+        .sin_port = htons(local_port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&local, sizeof(local)) < 0)
+    {
+        ESP_LOGE(TAG, "bind to port %u failed: %s", local_port, strerror(errno));
+        close(sock);
+        sock = -1;
+        return false;
+    }
+
+    recv_cb = on_receive;
+    if (recv_cb)
+    {
+        pthread_t t;
+        if (pthread_create(&t, NULL, receive_thread, NULL) != 0)
+        {
+            ESP_LOGE(TAG, "Failed to create receive thread");
+            return false;
+        }
+        pthread_detach(t);
+    }
+
+    ESP_LOGI(TAG, "UDP :%u -> %s:%u", local_port, peer_host, peer_port);
+    return true;
+}
+
+bool sim_transport_send(const uint8_t *data, size_t len)
+{
+    ssize_t sent = sendto(sock, data, len, 0, (struct sockaddr *)&peer_addr, sizeof(peer_addr));
+    // Nobody listening yet is normal while the peer process starts up
+    if (sent < 0 && errno != ECONNREFUSED)
+    {
+        ESP_LOGW(TAG, "sendto failed: %s", strerror(errno));
+        return false;
+    }
+    return sent == (ssize_t)len;
+}
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry trace (sim_trace.h) from a captured log.
+
+The firmware's drain task writes "#TRACE <lost> <base64>" lines to the
+console, mixed with ordinary ESP_LOG output. This picks them out, decodes
+the 16-byte records and prints them as text or CSV. Event names are read
+from sim_trace.h, so the two never drift apart.
+
+Record (little endian): seq (u32), timestamp_us (u32), event (u16),
+channel (u16), value (f32).
+
+Usage:
+    idf.py monitor | tee run.log
+    ./trace_decode.py run.log [--csv] [--event HEATER_CMD ...]
+With no file, reads stdin.
+"""
+import argparse
+import base64
+import os
+import re
+import struct
+import sys
+
+RECORD = struct.Struct("<IIHHf")
+HEADER_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "sim_trace.h")
+TRACE_LINE = re.compile(r"#TRACE (\d+) ([A-Za-z0-9+/=]*)")
+
+
+def load_event_names(path):
+    names = {}
+    with open(path) as f:
+        for m in re.finditer(r"SIM_TRACE_([A-Z0-9_]+)\s*=\s*(\d+)\s*,", f.read()):
+            names[int(m.group(2))] = m.group(1)
+    return names
+
+
+def records(lines):
+    """Yield (lost, seq, timestamp_us, event, channel, value) tuples, with
+    timestamps unwrapped to 64 bits. `lost` counts records dropped on the
+    device just before this one."""
+    wraps = 0
+    last_ts = None
+    lost = 0
+    for line in lines:
+        m = TRACE_LINE.search(line)
+        if not m:
+            continue
+        lost += int(m.group(1))
+        data = base64.b64decode(m.group(2))
+        for off in range(0, len(data) - RECORD.size + 1, RECORD.size):
+            seq, ts, event, channel, value = RECORD.unpack_from(data, off)
+            # Records are stamped after claiming their slot, so a preempted
+            # writer can land slightly behind its successor: only a big step
+            # back is the 32-bit microsecond clock wrapping
+            if last_ts is not None and last_ts - ts > 1 << 31:
+                wraps += 1
+            last_ts = ts
+            yield lost, seq, (wraps << 32) + ts, event, channel, value
+            lost = 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="captured console log (default: stdin)")
+    parser.add_argument("--csv", action="store_true", help="CSV instead of text")
+    parser.add_argument("--event", action="append", default=[],
+                        help="only this event (name without SIM_TRACE_), repeatable")
+    parser.add_argument("--header", default=HEADER_FILE, help="sim_trace.h to take names from")
+    args = parser.parse_args()
+
+    names = load_event_names(args.header)
+    wanted = {n.upper() for n in args.event}
+    src = open(args.log, errors="replace") if args.log else sys.stdin
+
+    total = 0
+    dropped = 0
+    prev_seq = None
+    t0 = None
+    if args.csv:
+        print("time_s,seq,event,channel,value")
+    for lost, seq, ts, event, channel, value in records(src):
+        # Gaps in seq also catch records lost between captured lines
+        if prev_seq is not None and seq > prev_seq + 1:
+            lost = max(lost, seq - prev_seq - 1)
+        prev_seq = seq
+        dropped += lost
+        total += 1
+        if t0 is None:
+            t0 = ts
+
+        name = names.get(event, "EVENT_%d" % event)
+        if wanted and name not in wanted:
+            continue
+        t = (ts - t0) / 1e6
+        if args.csv:
+            print("%.6f,%d,%s,%d,%g" % (t, seq, name, channel, value))
+        else:
+            if lost:
+                print("            ... %d record(s) lost" % lost)
+            print("%12.6f  %-14s ch %-5d %g" % (t, name, channel, value))
+
+    print("%d record(s), %d lost" % (total, dropped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
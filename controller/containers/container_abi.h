@@ -0,0 +1,26 @@
+#pragma once
+#include "container_io.h"
+
+// Container ABI shared by all control containers.
+//
+// The host instantiates the container once, calls init() and then calls
+// step(dt) at a fixed rate from its own scheduler, with dt the time in
+// seconds since the previous step (a multiple of the period if the host
+// skipped periods). step() must return promptly: no loops, no host_delay().
+// A step running past its budget (one period by default, see the host's
+// main/container_budget.h) is cut short and its actuator writes dropped.
+//
+// Channels are exchanged through the shared I/O window (container_io.h):
+// fetch it once with host_io_window() in init(), then read sensors[] and
+// write actuators[] with container_io_set() inside step(). The per-sample
+// natives below remain for legacy containers.
+
+#define CONTAINER_EXPORT(name) __attribute__((export_name(#name)))
+
+// Host natives (module "env")
+extern void host_set_heater(int value);       // 0 = OFF, else full power
+extern void host_set_heater_duty(float duty); // Proportional: 0.0 .. 1.0, clamped
+extern float host_get_temperature(void);
+extern void host_delay(int ms); // Legacy main()-loop containers only
+extern void host_log(const char *msg);
+extern container_io_t *host_io_window(void); // NULL if the host has none
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+// Shared I/O window between host and container. Included by both sides:
+// the layout is identical in wasm32 and on the host (little-endian, 4-byte
+// fields only).
+//
+// The host allocates one window per instance in the container's linear
+// memory. Before every step() it writes all sensor channels into it, and
+// after step() it reads back the actuator channels the container marked
+// dirty. Reading and writing channels is plain memory access, so a step costs
+// one boundary crossing however many channels it uses.
+
+#define CONTAINER_IO_CHANNELS 16
+
+// Channel assignment of the heater controller
+#define CONTAINER_IO_TEMPERATURE     0 // sensors[]: plant temperature (C)
+#define CONTAINER_IO_TEMPERATURE_MIN 1 // sensors[]: min over the last ADC window,
+#define CONTAINER_IO_TEMPERATURE_MAX 2 //   max, and variance (C^2); only where the
+#define CONTAINER_IO_TEMPERATURE_VAR 3 //   host samples continuously (sensor_count 4)
+#define CONTAINER_IO_HEATER          0 // actuators[]: heater duty 0..1 (clamped), 0 = OFF
+
+typedef struct {
+    uint32_t sensor_count;   // Valid entries in sensors[], set by the host
+    uint32_t actuator_dirty; // Bit i: actuators[i] written during this step
+    float sensors[CONTAINER_IO_CHANNELS];
+    float actuators[CONTAINER_IO_CHANNELS];
+} container_io_t;
+
+static inline void container_io_set(container_io_t *io, uint32_t channel, float value)
+{
+    io->actuators[channel] = value;
+    io->actuator_dirty |= 1u << channel;
+}
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Size report of compiled containers.
+
+For every .wasm: file size split into code, data and custom sections
+(debug info, names), imports (WASI ones flagged), exports, and linear memory
+declared versus needed. "Needed" is static data plus the shadow stack, what
+WAMR shrinks the memory to at load time when the module exports __heap_base
+and __data_end and never grows its memory; the host adds the app heap on top
+(app_heap of the container's .mem manifest, CONTAINER_HEAP_SIZE without one).
+
+Usage:
+    ./container_size_report.py [files...]
+With no files, every .wasm in ../wasm_assets is reported.
+"""
+import argparse
+import glob
+import os
+import sys
+
+PAGE = 65536
+MEMORY_GROW = 0x40
+
+SECTION_CUSTOM, SECTION_IMPORT, SECTION_MEMORY = 0, 2, 5
+SECTION_GLOBAL, SECTION_EXPORT, SECTION_CODE, SECTION_DATA = 6, 7, 10, 11
+
+
+class Reader:
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos
+
+    def byte(self):
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def uleb(self):
+        result = shift = 0
+        while True:
+            b = self.byte()
+            result |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                return result
+
+    def sleb(self):
+        result = shift = 0
+        while True:
+            b = self.byte()
+            result |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                if b & 0x40:
+                    result -= 1 << shift
+                return result
+
+    def name(self):
+        n = self.uleb()
+        self.pos += n
+        return self.data[self.pos - n:self.pos].decode(errors="replace")
+
+    def limits(self):
+        flags = self.byte()
+        minimum = self.uleb()
+        maximum = self.uleb() if flags & 1 else None
+        return minimum, maximum
+
+    def const_expr(self):
+        """i32.const value of an init expression, None for anything else."""
+        op = self.byte()
+        value = self.sleb() if op == 0x41 else None
+        while op != 0x0B:  # Skip to end
+            op = self.byte()
+        return value
+
+
+def analyze(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\0asm":
+        sys.exit("Error: not a wasm module: %s" % path)
+
+    info = {"file": len(data), "code": 0, "data": 0, "custom": 0, "imports": [],
+            "exports": [], "pages": (0, None), "data_end": 0, "globals": [],
+            "imported_globals": 0, "grows": False}
+    r = Reader(data, 8)
+    while r.pos < len(data):
+        section = r.byte()
+        size = r.uleb()
+        body = Reader(data, r.pos)
+        r.pos += size
+
+        if section == SECTION_CUSTOM:
+            info["custom"] += size
+        elif section == SECTION_CODE:
+            info["code"] = size
+            # Coarse scan for memory.grow (0x40 0x00): a false positive only
+            # reports "no shrink", never the reverse
+            info["grows"] = bytes([MEMORY_GROW, 0]) in data[body.pos:r.pos]
+        elif section == SECTION_DATA:
+            info["data"] = size
+            for _ in range(body.uleb()):
+                kind = body.uleb()  # 0: active, 1: passive, 2: active with memory index
+                if kind == 2:
+                    body.uleb()
+                offset = body.const_expr() if kind != 1 else None
+                length = body.uleb()
+                body.pos += length
+                if offset is not None:
+                    info["data_end"] = max(info["data_end"], offset + length)
+        elif section == SECTION_IMPORT:
+            for _ in range(body.uleb()):
+                module, field, kind = body.name(), body.name(), body.byte()
+                if kind == 0:
+                    body.uleb()
+                elif kind == 1:
+                    body.byte()
+                    body.limits()
+                elif kind == 2:
+                    body.limits()
+                else:
+                    body.pos += 2
+                    info["imported_globals"] += 1
+                info["imports"].append((module, field))
+        elif section == SECTION_MEMORY:
+            if body.uleb():
+                info["pages"] = body.limits()
+        elif section == SECTION_GLOBAL:
+            for _ in range(body.uleb()):
+                valtype, mutable = body.byte(), body.byte()
+                info["globals"].append((valtype, mutable, body.const_expr()))
+        elif section == SECTION_EXPORT:
+            for _ in range(body.uleb()):
+                name, kind, index = body.name(), body.byte(), body.uleb()
+                info["exports"].append((name, kind, index))
+    return info
+
+
+def memory_need(info):
+    """(bytes needed, shrinkable) for the static data and shadow stack."""
+    exported = {name: index for name, kind, index in info["exports"] if kind == 3}
+
+    def global_value(index):
+        i = index - info["imported_globals"]
+        return info["globals"][i][2] if 0 <= i < len(info["globals"]) else None
+
+    heap_base = global_value(exported["__heap_base"]) if "__heap_base" in exported else None
+    shrinkable = (heap_base is not None and "__data_end" in exported and not info["grows"])
+
+    # Without the exports: the stack pointer (first mutable i32 global)
+    # starts at the top of the stack, above the data
+    stack_top = next((v for t, m, v in info["globals"] if t == 0x7F and m and v is not None), 0)
+    need = max(heap_base or 0, stack_top, info["data_end"])
+    return (need + 15) & ~15, shrinkable
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="*")
+    args = parser.parse_args()
+
+    files = args.files or sorted(glob.glob(os.path.join(here, "..", "wasm_assets", "*.wasm")))
+    if not files:
+        sys.exit("Error: no .wasm files")
+
+    print("%-20s %8s %7s %7s %7s %7s %7s %9s %9s %s" % (
+        "container", "file", "code", "data", "custom", "imports", "exports",
+        "mem decl", "mem need", "shrinks"))
+    for path in files:
+        info = analyze(path)
+        need, shrinkable = memory_need(info)
+        declared = info["pages"][0] * PAGE
+        wasi = [f for m, f in info["imports"] if m.startswith("wasi")]
+        print("%-20s %8d %7d %7d %7d %7d %7d %9d %9d %s" % (
+            os.path.basename(path)[:20], info["file"], info["code"], info["data"],
+            info["custom"], len(info["imports"]), len(info["exports"]), declared, need,
+            "yes" if shrinkable else "no"))
+        if wasi:
+            print("%-20s WASI imports: %s" % ("", ", ".join(wasi)))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,57 +1,68 @@
-
-
-extern void host_set_heater(int value);
-extern float host_get_temperature(void); // This can stay float
-extern void host_delay(int ms);
-extern void host_log(const char *msg);
+#include "container_abi.h"
+#include "signal_filter.h"
 
 // Control parameters
 #define TARGET_TEMP     50.0f   // Target temperature in Celsius
 #define HYSTERESIS      1.0f    // +/- 1°C hysteresis band
-#define CONTROL_PERIOD  100     // Control loop period in ms
+#define SPIKE_WINDOW    3       // Median-of-3: one outlier never switches the heater
 
-int main()
+static int heater_state = 0;
+static container_io_t *io = 0;
+static sf_median_f32_t spike_filter;
+
+CONTAINER_EXPORT(init)
+void init(void)
 {
     host_log("Temperature Controller Started");
     host_log("Target: 50C with +/-1C hysteresis");
 
-    float current_temp;
-    int heater_state = 0;
+    io = host_io_window();
+    heater_state = 0;
+    host_set_heater(0);
 
-    // Main control loop
-    while (1)
-    {
-        // Read current temperature
-        current_temp = host_get_temperature();
+    // Start from the setpoint: inside the band, so the first samples cannot
+    // trigger a switch on their own
+    sf_median_f32_init(&spike_filter, SPIKE_WINDOW, TARGET_TEMP);
+}
+
+static void set_heater(int on)
+{
+    if (io)
+        container_io_set(io, CONTAINER_IO_HEATER, on ? 1.0f : 0.0f);
+    else
+        host_set_heater(on);
+}
 
-        // Bang-bang control with hysteresis
-        // Turn ON heater if temp falls below (target - hysteresis)
-        // Turn OFF heater if temp rises above (target + hysteresis)
-        if (current_temp < (TARGET_TEMP - HYSTERESIS))
+// Called by the host once per control period
+CONTAINER_EXPORT(step)
+void step(float dt)
+{
+    // Read current temperature (the window saves a native call per sample)
+    float current_temp = io ? io->sensors[CONTAINER_IO_TEMPERATURE] : host_get_temperature();
+    sf_median_f32(&spike_filter, &current_temp, &current_temp, 1);
+
+    // Bang-bang control with hysteresis
+    // Turn ON heater if temp falls below (target - hysteresis)
+    // Turn OFF heater if temp rises above (target + hysteresis)
+    if (current_temp < (TARGET_TEMP - HYSTERESIS))
+    {
+        // Too cold - turn heater ON
+        if (heater_state == 0)
         {
-            // Too cold - turn heater ON
-            if (heater_state == 0)
-            {
-                host_set_heater(1);
-                heater_state = 1;
-                host_log("Heater ON - temp below threshold");
-            }
+            set_heater(1);
+            heater_state = 1;
+            host_log("Heater ON - temp below threshold");
         }
-        else if (current_temp > (TARGET_TEMP + HYSTERESIS))
+    }
+    else if (current_temp > (TARGET_TEMP + HYSTERESIS))
+    {
+        // Too hot - turn heater OFF
+        if (heater_state == 1)
         {
-            // Too hot - turn heater OFF
-            if (heater_state == 1)
-            {
-                host_set_heater(0);
-                heater_state = 0;
-                host_log("Heater OFF - temp above threshold");
-            }
+            set_heater(0);
+            heater_state = 0;
+            host_log("Heater OFF - temp above threshold");
         }
-        // Within hysteresis band - maintain current state
-
-        // Wait for next control cycle
-        host_delay(CONTROL_PERIOD);
     }
-
-    return 0;
+    // Within hysteresis band - maintain current state
 }
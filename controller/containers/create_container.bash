@@ -5,14 +5,44 @@ WASI_SDK_PATH="/opt/wasi-sdk"
 CC="${WASI_SDK_PATH}/bin/clang"
 OUTPUT_DIR="../wasm_assets"
 
+# AOT compiler (built from wamr-compiler/ of the same WAMR release as the
+# firmware, otherwise the runtime rejects the image and falls back to the
+# interpreter). Target matches the ESP32 (Xtensa LX6) controller board.
+WAMRC="${WAMRC:-wamrc}"
+AOT_TARGET="${AOT_TARGET:-xtensa}"
+AOT_CPU="${AOT_CPU:-esp32}"
+
+# Signal filter library (lib/signal_filter.h). Linked into every container
+# by default; FILTER_LIB=native leaves the sf_* functions undefined so they
+# are imported from the host (main/filter_natives.c) and run natively.
+FILTER_LIB="${FILTER_LIB:-link}"
+LIB_DIR="lib"
+
+# WASM_SIMD=1 adds -msimd128 so the filter kernels vectorize. Only for
+# runtimes built with WAMR_BUILD_SIMD; the ESP32 (Xtensa) build has none.
+WASM_SIMD="${WASM_SIMD:-0}"
+
+# Build profile:
+#   default  WASI libc, reactor model (what containers were always built with)
+#   size     no libc and no WASI imports: memcpy/memset & co. resolve to the
+#            runtime's libc-builtin natives. Unused code and exports are
+#            dropped, debug/name sections stripped, and __heap_base and
+#            __data_end exported so WAMR shrinks the 64 KB linear memory down
+#            to data + stack at load. Needs wasm-opt (binaryen) for the final
+#            size pass; skipped with a warning if missing. Containers calling
+#            libm (e.g. sf_biquad_lowpass) must use the default profile.
+PROFILE="${PROFILE:-default}"
+WASM_OPT="${WASM_OPT:-wasm-opt}"
+
 # Ensure output directory exists
 mkdir -p "$OUTPUT_DIR"
 
 # Compilation flags
 # -O3: Optimization
 # --target=wasm32-wasi: Target WebAssembly with WASI
+# -mexec-model=reactor: No main(); the host calls the init/step exports
+#   (marked with CONTAINER_EXPORT in container_abi.h) on its own schedule
 # -Wl,--allow-undefined: Allow undefined symbols (for host functions)
-# -Wl,--export=main: Export main function
 # Note: initial-memory must be multiple of 65536 (WASM page size)
 # Using minimum 1 page (65536 bytes) for ESP32 memory constraints
 CFLAGS="-O3 \
@@ -20,8 +50,81 @@ CFLAGS="-O3 \
     -Wl,--initial-memory=65536 \
     -Wl,--max-memory=65536 \
     -z stack-size=2048 \
-    -Wl,--export=main \
-    -Wl,--allow-undefined "
+    -mexec-model=reactor \
+    -Wl,--allow-undefined \
+    -I $LIB_DIR "
+
+SIZE_CFLAGS="-Oz \
+    --target=wasm32-wasi \
+    -nostdlib \
+    -ffunction-sections \
+    -fdata-sections \
+    -Wl,--no-entry \
+    -Wl,--gc-sections \
+    -Wl,--strip-all \
+    -Wl,--export=__heap_base \
+    -Wl,--export=__data_end \
+    -Wl,--initial-memory=65536 \
+    -Wl,--max-memory=65536 \
+    -z stack-size=2048 \
+    -Wl,--allow-undefined \
+    -I $LIB_DIR "
+
+case "$PROFILE" in
+    default) ;;
+    size) CFLAGS="$SIZE_CFLAGS" ;;
+    *)
+        echo "Error: unknown PROFILE $PROFILE (default or size)"
+        exit 1
+        ;;
+esac
+
+if [ "$WASM_SIMD" = "1" ]; then
+    CFLAGS="$CFLAGS -msimd128"
+fi
+
+LIB_SOURCES=""
+if [ "$FILTER_LIB" != "native" ]; then
+    LIB_SOURCES="$LIB_DIR/signal_filter.c"
+fi
+
+# Size pass over a linked .wasm (size profile only). Features match what the
+# runtime accepts: WAMR's always-on set plus bulk memory.
+optimize_file() {
+    local wasm_file="$1"
+
+    if ! command -v "$WASM_OPT" >/dev/null 2>&1; then
+        echo "Warning: $WASM_OPT not found, skipping size pass of $wasm_file"
+        return 0
+    fi
+    "$WASM_OPT" -Oz --strip-debug --strip-producers \
+        --enable-bulk-memory --enable-sign-ext --enable-nontrapping-float-to-int \
+        --enable-mutable-globals --enable-multivalue \
+        -o "$wasm_file" "$wasm_file" || exit 1
+}
+
+# AOT-compile a .wasm next to itself. Skipped (with a warning) when wamrc is
+# not installed: the controller then runs the .wasm in the interpreter.
+aot_compile_file() {
+    local wasm_file="$1"
+    local aot_file="${wasm_file%.wasm}.aot"
+
+    if ! command -v "$WAMRC" >/dev/null 2>&1; then
+        echo "Warning: $WAMRC not found, skipping AOT compilation of $wasm_file"
+        rm -f "$aot_file"
+        return 0
+    fi
+
+    echo "AOT compiling $wasm_file to $aot_file..."
+    "$WAMRC" --target="$AOT_TARGET" --cpu="$AOT_CPU" -o "$aot_file" "$wasm_file"
+
+    if [ $? -eq 0 ]; then
+        echo "Success: $aot_file"
+    else
+        echo "Failed to AOT compile $wasm_file"
+        exit 1
+    fi
+}
 
 compile_file() {
     local input_file="$1"
@@ -37,7 +140,7 @@ compile_file() {
         exit 1
     fi
 
-    "$CC" $CFLAGS -o "$output_file" "$input_file"
+    "$CC" $CFLAGS -o "$output_file" "$input_file" $LIB_SOURCES
     
     if [ $? -eq 0 ]; then
         echo "Success: $output_file"
@@ -45,6 +148,11 @@ compile_file() {
         echo "Failed to compile $input_file"
         exit 1
     fi
+
+    if [ "$PROFILE" = "size" ]; then
+        optimize_file "$output_file"
+    fi
+    aot_compile_file "$output_file"
 }
 
 if [ -n "$1" ]; then
@@ -73,4 +181,8 @@ fi
 
 echo ""
 echo "Compiled binaries:"
-ls -lh "$OUTPUT_DIR"/*.wasm 2>/dev/null
+ls -lh "$OUTPUT_DIR"/*.wasm "$OUTPUT_DIR"/*.aot 2>/dev/null
+
+# Code / data / linear memory per container, also kept next to the binaries
+echo ""
+./container_size_report.py "$OUTPUT_DIR"/*.wasm | tee "$OUTPUT_DIR/size_report.txt"
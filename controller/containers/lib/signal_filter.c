@@ -0,0 +1,543 @@
+#include <math.h>
+#include "signal_filter.h"
+
+#define PI      3.14159265f
+#define Q14_ONE 16384.0f
+#define Q30_ONE 1073741824.0f
+#define Q31_ONE 2147483648.0f
+
+static inline uint32_t min_u32(uint32_t a, uint32_t b)
+{
+    return a < b ? a : b;
+}
+
+static inline int16_t sat16(int64_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+static inline int32_t sat32(int64_t v)
+{
+    return v > INT32_MAX ? INT32_MAX : v < INT32_MIN ? INT32_MIN : (int32_t)v;
+}
+
+static int64_t to_fixed(float v, float one, int64_t lo, int64_t hi)
+{
+    float scaled = roundf(v * one);
+    if (scaled >= (float)hi)
+        return hi;
+    if (scaled <= (float)lo)
+        return lo;
+    return (int64_t)scaled;
+}
+
+// Steady-state output of a biquad fed a constant forever
+static float biquad_dc_gain(const float c[SF_BIQUAD_COEFFS])
+{
+    float den = 1.0f + c[3] + c[4];
+    return den != 0.0f ? (c[0] + c[1] + c[2]) / den : 1.0f;
+}
+
+void sf_biquad_lowpass(float coeffs[SF_BIQUAD_COEFFS], float fc_hz, float fs_hz, float q)
+{
+    float w0 = 2.0f * PI * fc_hz / fs_hz;
+    float cw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+
+    coeffs[0] = (1.0f - cw) / 2.0f / a0;
+    coeffs[1] = (1.0f - cw) / a0;
+    coeffs[2] = coeffs[0];
+    coeffs[3] = -2.0f * cw / a0;
+    coeffs[4] = (1.0f - alpha) / a0;
+}
+
+// Median window: replace the oldest sample in the sorted copy with the new
+// one and slide it into place (insertion sort step, O(len))
+#define MEDIAN_REPLACE(sorted, len, old, x)                   \
+    do                                                        \
+    {                                                         \
+        uint32_t i_ = 0;                                      \
+        while (i_ + 1 < (len) && (sorted)[i_] != (old))       \
+            i_++;                                             \
+        while (i_ > 0 && (sorted)[i_ - 1] > (x))              \
+        {                                                     \
+            (sorted)[i_] = (sorted)[i_ - 1];                  \
+            i_--;                                             \
+        }                                                     \
+        while (i_ + 1 < (len) && (sorted)[i_ + 1] < (x))      \
+        {                                                     \
+            (sorted)[i_] = (sorted)[i_ + 1];                  \
+            i_++;                                             \
+        }                                                     \
+        (sorted)[i_] = (x);                                   \
+    } while (0)
+
+static uint32_t median_len(uint32_t len)
+{
+    if (len < 1)
+        len = 1;
+    if (len > SF_MEDIAN_MAX)
+        len = SF_MEDIAN_MAX;
+    return len | 1;
+}
+
+static uint32_t ma_len(uint32_t len)
+{
+    if (len < 1)
+        return 1;
+    return len > SF_MA_MAX ? SF_MA_MAX : len;
+}
+
+// ============================================================================
+// FLOAT
+// ============================================================================
+
+void sf_ma_f32_init(sf_ma_f32_t *s, uint32_t len, float initial)
+{
+    s->len = ma_len(len);
+    s->pos = 0;
+    for (uint32_t i = 0; i < s->len; i++)
+    {
+        s->hist[i] = initial;
+    }
+    s->sum = initial * (float)s->len;
+}
+
+void sf_ma_f32(sf_ma_f32_t *s, const float *in, float *out, uint32_t n)
+{
+    const float scale = 1.0f / (float)s->len;
+    float d[SF_CHUNK];
+
+    while (n > 0)
+    {
+        // Up to the ring wrap, so the history is one contiguous run
+        uint32_t m = min_u32(min_u32(n, SF_CHUNK), s->len - s->pos);
+        float *h = &s->hist[s->pos];
+        for (uint32_t k = 0; k < m; k++)
+        {
+            float x = in[k];
+            d[k] = x - h[k];
+            h[k] = x;
+        }
+
+        float sum = s->sum;
+        for (uint32_t k = 0; k < m; k++)
+        {
+            sum += d[k];
+            out[k] = sum * scale;
+        }
+        s->sum = sum;
+
+        s->pos += m;
+        if (s->pos == s->len)
+        {
+            // Re-sum once per lap so rounding errors cannot accumulate
+            s->pos = 0;
+            sum = 0.0f;
+            for (uint32_t k = 0; k < s->len; k++)
+            {
+                sum += s->hist[k];
+            }
+            s->sum = sum;
+        }
+        in += m;
+        out += m;
+        n -= m;
+    }
+}
+
+void sf_ema_f32_init(sf_ema_f32_t *s, float alpha, float initial)
+{
+    s->alpha = alpha;
+    s->y = initial;
+}
+
+void sf_ema_f32(sf_ema_f32_t *s, const float *in, float *out, uint32_t n)
+{
+    const float a = s->alpha;
+    const float keep = 1.0f - a;
+    float ax[SF_CHUNK];
+    float y = s->y;
+
+    while (n > 0)
+    {
+        uint32_t m = min_u32(n, SF_CHUNK);
+        for (uint32_t k = 0; k < m; k++)
+        {
+            ax[k] = a * in[k];
+        }
+        for (uint32_t k = 0; k < m; k++)
+        {
+            y = keep * y + ax[k];
+            out[k] = y;
+        }
+        in += m;
+        out += m;
+        n -= m;
+    }
+    s->y = y;
+}
+
+void sf_biquad_f32_init(sf_biquad_f32_t *s, const float coeffs[SF_BIQUAD_COEFFS], float initial)
+{
+    for (int i = 0; i < SF_BIQUAD_COEFFS; i++)
+    {
+        s->c[i] = coeffs[i];
+    }
+    s->x1 = s->x2 = initial;
+    s->y1 = s->y2 = initial * biquad_dc_gain(coeffs);
+}
+
+void sf_biquad_f32(sf_biquad_f32_t *s, const float *in, float *out, uint32_t n)
+{
+    const float b0 = s->c[0], b1 = s->c[1], b2 = s->c[2], a1 = s->c[3], a2 = s->c[4];
+    float x[SF_CHUNK + 2];
+    float f[SF_CHUNK];
+    float y1 = s->y1, y2 = s->y2;
+
+    x[0] = s->x2;
+    x[1] = s->x1;
+    while (n > 0)
+    {
+        uint32_t m = min_u32(n, SF_CHUNK);
+        for (uint32_t k = 0; k < m; k++)
+        {
+            x[k + 2] = in[k];
+        }
+        // Feed-forward taps for the whole piece
+        for (uint32_t k = 0; k < m; k++)
+        {
+            f[k] = b0 * x[k + 2] + b1 * x[k + 1] + b2 * x[k];
+        }
+        for (uint32_t k = 0; k < m; k++)
+        {
+            float y = f[k] - a1 * y1 - a2 * y2;
+            y2 = y1;
+            y1 = y;
+            out[k] = y;
+        }
+        x[0] = x[m];
+        x[1] = x[m + 1];
+        in += m;
+        out += m;
+        n -= m;
+    }
+    s->x2 = x[0];
+    s->x1 = x[1];
+    s->y1 = y1;
+    s->y2 = y2;
+}
+
+void sf_median_f32_init(sf_median_f32_t *s, uint32_t len, float initial)
+{
+    s->len = median_len(len);
+    s->pos = 0;
+    for (uint32_t i = 0; i < s->len; i++)
+    {
+        s->hist[i] = initial;
+        s->sorted[i] = initial;
+    }
+}
+
+void sf_median_f32(sf_median_f32_t *s, const float *in, float *out, uint32_t n)
+{
+    const uint32_t len = s->len;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        float x = in[k];
+        float old = s->hist[s->pos];
+        s->hist[s->pos] = x;
+        s->pos = s->pos + 1 == len ? 0 : s->pos + 1;
+        MEDIAN_REPLACE(s->sorted, len, old, x);
+        out[k] = s->sorted[len / 2];
+    }
+}
+
+// ============================================================================
+// Q15
+// ============================================================================
+
+void sf_ma_q15_init(sf_ma_q15_t *s, uint32_t len, int16_t initial)
+{
+    s->len = ma_len(len);
+    s->pos = 0;
+    s->recip = (uint32_t)((1ull << 31) / s->len);
+    for (uint32_t i = 0; i < s->len; i++)
+    {
+        s->hist[i] = initial;
+    }
+    s->sum = (int32_t)initial * (int32_t)s->len;
+}
+
+void sf_ma_q15(sf_ma_q15_t *s, const int16_t *in, int16_t *out, uint32_t n)
+{
+    const int64_t recip = s->recip;
+    int32_t d[SF_CHUNK];
+
+    while (n > 0)
+    {
+        uint32_t m = min_u32(min_u32(n, SF_CHUNK), s->len - s->pos);
+        int16_t *h = &s->hist[s->pos];
+        for (uint32_t k = 0; k < m; k++)
+        {
+            int16_t x = in[k];
+            d[k] = (int32_t)x - h[k];
+            h[k] = x;
+        }
+
+        // Integer sums are exact: no periodic re-sum needed
+        int32_t sum = s->sum;
+        for (uint32_t k = 0; k < m; k++)
+        {
+            sum += d[k];
+            out[k] = (int16_t)((sum * recip + (1ll << 30)) >> 31);
+        }
+        s->sum = sum;
+
+        s->pos += m;
+        if (s->pos == s->len)
+            s->pos = 0;
+        in += m;
+        out += m;
+        n -= m;
+    }
+}
+
+void sf_ema_q15_init(sf_ema_q15_t *s, float alpha, int16_t initial)
+{
+    s->alpha = (int32_t)to_fixed(alpha, 32768.0f, 1, 32768);
+    s->y = (int32_t)initial << 16;
+}
+
+void sf_ema_q15(sf_ema_q15_t *s, const int16_t *in, int16_t *out, uint32_t n)
+{
+    const int64_t a = s->alpha;
+    int64_t y = s->y;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        int64_t x = (int64_t)in[k] << 16;
+        y += ((x - y) * a) >> 15;
+        out[k] = sat16((y + (1 << 15)) >> 16);
+    }
+    s->y = (int32_t)y;
+}
+
+void sf_biquad_q15_init(sf_biquad_q15_t *s, const float coeffs[SF_BIQUAD_COEFFS], int16_t initial)
+{
+    for (int i = 0; i < SF_BIQUAD_COEFFS; i++)
+    {
+        s->c[i] = (int16_t)to_fixed(coeffs[i], Q14_ONE, INT16_MIN, INT16_MAX);
+    }
+    s->x1 = s->x2 = initial;
+    s->y1 = s->y2 = sat16((int64_t)roundf(initial * biquad_dc_gain(coeffs)));
+}
+
+void sf_biquad_q15(sf_biquad_q15_t *s, const int16_t *in, int16_t *out, uint32_t n)
+{
+    const int32_t b0 = s->c[0], b1 = s->c[1], b2 = s->c[2], a1 = s->c[3], a2 = s->c[4];
+    int32_t x[SF_CHUNK + 2];
+    int64_t f[SF_CHUNK];
+    int32_t y1 = s->y1, y2 = s->y2;
+
+    x[0] = s->x2;
+    x[1] = s->x1;
+    while (n > 0)
+    {
+        uint32_t m = min_u32(n, SF_CHUNK);
+        for (uint32_t k = 0; k < m; k++)
+        {
+            x[k + 2] = in[k];
+        }
+        // Q15 x Q14 = Q29; three taps can exceed 32 bits
+        for (uint32_t k = 0; k < m; k++)
+        {
+            f[k] = (int64_t)(b0 * x[k + 2]) + b1 * x[k + 1] + b2 * x[k];
+        }
+        for (uint32_t k = 0; k < m; k++)
+        {
+            int64_t acc = f[k] - (int64_t)a1 * y1 - (int64_t)a2 * y2;
+            int32_t y = sat16((acc + (1 << 13)) >> 14);
+            y2 = y1;
+            y1 = y;
+            out[k] = (int16_t)y;
+        }
+        x[0] = x[m];
+        x[1] = x[m + 1];
+        in += m;
+        out += m;
+        n -= m;
+    }
+    s->x2 = (int16_t)x[0];
+    s->x1 = (int16_t)x[1];
+    s->y1 = (int16_t)y1;
+    s->y2 = (int16_t)y2;
+}
+
+void sf_median_q15_init(sf_median_q15_t *s, uint32_t len, int16_t initial)
+{
+    s->len = median_len(len);
+    s->pos = 0;
+    for (uint32_t i = 0; i < s->len; i++)
+    {
+        s->hist[i] = initial;
+        s->sorted[i] = initial;
+    }
+}
+
+void sf_median_q15(sf_median_q15_t *s, const int16_t *in, int16_t *out, uint32_t n)
+{
+    const uint32_t len = s->len;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        int16_t x = in[k];
+        int16_t old = s->hist[s->pos];
+        s->hist[s->pos] = x;
+        s->pos = s->pos + 1 == len ? 0 : s->pos + 1;
+        MEDIAN_REPLACE(s->sorted, len, old, x);
+        out[k] = s->sorted[len / 2];
+    }
+}
+
+// ============================================================================
+// Q31
+// ============================================================================
+
+void sf_ma_q31_init(sf_ma_q31_t *s, uint32_t len, int32_t initial)
+{
+    s->len = ma_len(len);
+    s->pos = 0;
+    for (uint32_t i = 0; i < s->len; i++)
+    {
+        s->hist[i] = initial;
+    }
+    s->sum = (int64_t)initial * s->len;
+}
+
+void sf_ma_q31(sf_ma_q31_t *s, const int32_t *in, int32_t *out, uint32_t n)
+{
+    const int64_t len = s->len;
+    int64_t d[SF_CHUNK];
+
+    while (n > 0)
+    {
+        uint32_t m = min_u32(min_u32(n, SF_CHUNK), s->len - s->pos);
+        int32_t *h = &s->hist[s->pos];
+        for (uint32_t k = 0; k < m; k++)
+        {
+            int32_t x = in[k];
+            d[k] = (int64_t)x - h[k];
+            h[k] = x;
+        }
+
+        int64_t sum = s->sum;
+        for (uint32_t k = 0; k < m; k++)
+        {
+            sum += d[k];
+            out[k] = (int32_t)(sum / len);
+        }
+        s->sum = sum;
+
+        s->pos += m;
+        if (s->pos == s->len)
+            s->pos = 0;
+        in += m;
+        out += m;
+        n -= m;
+    }
+}
+
+void sf_ema_q31_init(sf_ema_q31_t *s, float alpha, int32_t initial)
+{
+    s->alpha = (int32_t)to_fixed(alpha, Q31_ONE, 1, INT32_MAX);
+    s->y = initial;
+}
+
+void sf_ema_q31(sf_ema_q31_t *s, const int32_t *in, int32_t *out, uint32_t n)
+{
+    const int64_t a = s->alpha;
+    int64_t y = s->y;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        y += (((int64_t)in[k] - y) * a) >> 31;
+        out[k] = (int32_t)y;
+    }
+    s->y = (int32_t)y;
+}
+
+void sf_biquad_q31_init(sf_biquad_q31_t *s, const float coeffs[SF_BIQUAD_COEFFS], int32_t initial)
+{
+    for (int i = 0; i < SF_BIQUAD_COEFFS; i++)
+    {
+        s->c[i] = (int32_t)to_fixed(coeffs[i], Q30_ONE, INT32_MIN, INT32_MAX);
+    }
+    s->x1 = s->x2 = initial;
+    s->y1 = s->y2 = sat32((int64_t)((double)initial * biquad_dc_gain(coeffs)));
+}
+
+void sf_biquad_q31(sf_biquad_q31_t *s, const int32_t *in, int32_t *out, uint32_t n)
+{
+    const int64_t b0 = s->c[0], b1 = s->c[1], b2 = s->c[2], a1 = s->c[3], a2 = s->c[4];
+    int64_t x[SF_CHUNK + 2];
+    int64_t f[SF_CHUNK];
+    int64_t y1 = s->y1, y2 = s->y2;
+
+    x[0] = s->x2;
+    x[1] = s->x1;
+    while (n > 0)
+    {
+        uint32_t m = min_u32(n, SF_CHUNK);
+        for (uint32_t k = 0; k < m; k++)
+        {
+            x[k + 2] = in[k];
+        }
+        // Q31 x Q30 = Q61, brought back to Q31 per tap so the sum fits
+        for (uint32_t k = 0; k < m; k++)
+        {
+            f[k] = ((b0 * x[k + 2]) >> 30) + ((b1 * x[k + 1]) >> 30) + ((b2 * x[k]) >> 30);
+        }
+        for (uint32_t k = 0; k < m; k++)
+        {
+            int64_t y = sat32(f[k] - ((a1 * y1) >> 30) - ((a2 * y2) >> 30));
+            y2 = y1;
+            y1 = y;
+            out[k] = (int32_t)y;
+        }
+        x[0] = x[m];
+        x[1] = x[m + 1];
+        in += m;
+        out += m;
+        n -= m;
+    }
+    s->x2 = (int32_t)x[0];
+    s->x1 = (int32_t)x[1];
+    s->y1 = (int32_t)y1;
+    s->y2 = (int32_t)y2;
+}
+
+void sf_median_q31_init(sf_median_q31_t *s, uint32_t len, int32_t initial)
+{
+    s->len = median_len(len);
+    s->pos = 0;
+    for (uint32_t i = 0; i < s->len; i++)
+    {
+        s->hist[i] = initial;
+        s->sorted[i] = initial;
+    }
+}
+
+void sf_median_q31(sf_median_q31_t *s, const int32_t *in, int32_t *out, uint32_t n)
+{
+    const uint32_t len = s->len;
+    for (uint32_t k = 0; k < n; k++)
+    {
+        int32_t x = in[k];
+        int32_t old = s->hist[s->pos];
+        s->hist[s->pos] = x;
+        s->pos = s->pos + 1 == len ? 0 : s->pos + 1;
+        MEDIAN_REPLACE(s->sorted, len, old, x);
+        out[k] = s->sorted[len / 2];
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <stdint.h>
+
+// Signal-conditioning filters: moving average, EMA, biquad IIR and
+// median-of-N, each in float, Q15 (int16_t, 1.0 = 32768) and Q31 (int32_t,
+// 1.0 = 2^31) form.
+//
+// Shared by the host and containers, like container_io.h: the state structs
+// hold only fixed-width fields with natural alignment, so their layout is
+// the same in wasm32, on the ESP32 and on x86-64. A container keeps its
+// filter state in linear memory and either links signal_filter.c (the
+// create_container.bash default) or, built with FILTER_LIB=native, imports
+// the very same functions from the host (filter_natives.c), which runs them
+// as native code. Call sites do not change.
+//
+// Kernels take blocks: out[i] for in[i], i < n. in == out (in place) is
+// fine; other overlaps are not. Each block is cut into SF_CHUNK pieces and
+// every feed-forward part (ring differences, FIR taps, scaling) runs as a
+// branch-free loop over the piece, which the compiler vectorizes (SSE/NEON
+// on the host, SIMD128 when a container is built with -msimd128). The
+// recursions themselves (running sum, EMA, IIR feedback) stay serial.
+//
+// `initial` presets the filter as if it had seen that constant forever, so
+// there is no start-up transient from zero.
+
+#define SF_CHUNK      32 // Samples per vectorized piece (at most 0.5 KiB of stack)
+#define SF_MA_MAX     64 // Longest moving average
+#define SF_MEDIAN_MAX 15 // Longest median window (odd lengths only)
+
+// Biquad coefficients {b0, b1, b2, a1, a2}, a0 normalized to 1:
+//   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+// Fixed-point forms store them as Q14 (Q15 data) or Q30 (Q31 data), so
+// |coefficient| must stay below 2. Q15 feedback is truncated to 16 bits:
+// use Q31 for cutoffs below about fs/100.
+#define SF_BIQUAD_COEFFS 5
+
+// Butterworth-style (RBJ cookbook) low-pass design, q = 0.7071 for maximally
+// flat. Any format's *_init converts from these.
+void sf_biquad_lowpass(float coeffs[SF_BIQUAD_COEFFS], float fc_hz, float fs_hz, float q);
+
+// ============================================================================
+// FLOAT
+// ============================================================================
+
+typedef struct {
+    uint32_t len;
+    uint32_t pos;
+    float sum;
+    float hist[SF_MA_MAX];
+} sf_ma_f32_t;
+
+typedef struct {
+    float alpha; // Weight of the new sample, 0 < alpha <= 1
+    float y;
+} sf_ema_f32_t;
+
+typedef struct {
+    float c[SF_BIQUAD_COEFFS];
+    float x1, x2, y1, y2;
+} sf_biquad_f32_t;
+
+typedef struct {
+    uint32_t len;
+    uint32_t pos;
+    float hist[SF_MEDIAN_MAX];   // Arrival order (ring)
+    float sorted[SF_MEDIAN_MAX]; // Same samples, ascending
+} sf_median_f32_t;
+
+// len is clamped to 1..SF_MA_MAX
+void sf_ma_f32_init(sf_ma_f32_t *s, uint32_t len, float initial);
+void sf_ma_f32(sf_ma_f32_t *s, const float *in, float *out, uint32_t n);
+
+void sf_ema_f32_init(sf_ema_f32_t *s, float alpha, float initial);
+void sf_ema_f32(sf_ema_f32_t *s, const float *in, float *out, uint32_t n);
+
+void sf_biquad_f32_init(sf_biquad_f32_t *s, const float coeffs[SF_BIQUAD_COEFFS], float initial);
+void sf_biquad_f32(sf_biquad_f32_t *s, const float *in, float *out, uint32_t n);
+
+// len is clamped to 1..SF_MEDIAN_MAX and rounded up to odd
+void sf_median_f32_init(sf_median_f32_t *s, uint32_t len, float initial);
+void sf_median_f32(sf_median_f32_t *s, const float *in, float *out, uint32_t n);
+
+// ============================================================================
+// Q15
+// ============================================================================
+
+typedef struct {
+    uint32_t len;
+    uint32_t pos;
+    int32_t sum;    // Exact
+    uint32_t recip; // 2^31 / len: the mean is a multiply, not a divide
+    int16_t hist[SF_MA_MAX];
+} sf_ma_q15_t;
+
+typedef struct {
+    int32_t alpha; // Q15
+    int32_t y;     // Q31: the extra 16 bits avoid a dead band at small alpha
+} sf_ema_q15_t;
+
+typedef struct {
+    int16_t c[SF_BIQUAD_COEFFS]; // Q14
+    int16_t x1, x2, y1, y2;
+} sf_biquad_q15_t;
+
+typedef struct {
+    uint32_t len;
+    uint32_t pos;
+    int16_t hist[SF_MEDIAN_MAX];
+    int16_t sorted[SF_MEDIAN_MAX];
+} sf_median_q15_t;
+
+void sf_ma_q15_init(sf_ma_q15_t *s, uint32_t len, int16_t initial);
+void sf_ma_q15(sf_ma_q15_t *s, const int16_t *in, int16_t *out, uint32_t n);
+
+void sf_ema_q15_init(sf_ema_q15_t *s, float alpha, int16_t initial);
+void sf_ema_q15(sf_ema_q15_t *s, const int16_t *in, int16_t *out, uint32_t n);
+
+void sf_biquad_q15_init(sf_biquad_q15_t *s, const float coeffs[SF_BIQUAD_COEFFS], int16_t initial);
+void sf_biquad_q15(sf_biquad_q15_t *s, const int16_t *in, int16_t *out, uint32_t n);
+
+void sf_median_q15_init(sf_median_q15_t *s, uint32_t len, int16_t initial);
+void sf_median_q15(sf_median_q15_t *s, const int16_t *in, int16_t *out, uint32_t n);
+
+// ============================================================================
+// Q31
+// ============================================================================
+
+typedef struct {
+    uint32_t len;
+    uint32_t pos;
+    int64_t sum;
+    int32_t hist[SF_MA_MAX];
+} sf_ma_q31_t;
+
+typedef struct {
+    int32_t alpha; // Q31
+    int32_t y;
+} sf_ema_q31_t;
+
+typedef struct {
+    int32_t c[SF_BIQUAD_COEFFS]; // Q30
+    int32_t x1, x2, y1, y2;
+} sf_biquad_q31_t;
+
+typedef struct {
+    uint32_t len;
+    uint32_t pos;
+    int32_t hist[SF_MEDIAN_MAX];
+    int32_t sorted[SF_MEDIAN_MAX];
+} sf_median_q31_t;
+
+void sf_ma_q31_init(sf_ma_q31_t *s, uint32_t len, int32_t initial);
+void sf_ma_q31(sf_ma_q31_t *s, const int32_t *in, int32_t *out, uint32_t n);
+
+void sf_ema_q31_init(sf_ema_q31_t *s, float alpha, int32_t initial);
+void sf_ema_q31(sf_ema_q31_t *s, const int32_t *in, int32_t *out, uint32_t n);
+
+void sf_biquad_q31_init(sf_biquad_q31_t *s, const float coeffs[SF_BIQUAD_COEFFS], int32_t initial);
+void sf_biquad_q31(sf_biquad_q31_t *s, const int32_t *in, int32_t *out, uint32_t n);
+
+void sf_median_q31_init(sf_median_q31_t *s, uint32_t len, int32_t initial);
+void sf_median_q31(sf_median_q31_t *s, const int32_t *in, int32_t *out, uint32_t n);
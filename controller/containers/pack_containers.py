@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Pack compiled containers into a raw container store image.
+
+The image is flashed to the "containers" partition and memory-mapped by
+main/container_store.c, which executes containers in place from flash.
+
+Layout (little endian, see container_store.h):
+    header: magic "CTNR" (u32), version (u16), count (u16)
+    count x entry: name (32 bytes, NUL padded), offset (u32), size (u32)
+    payloads, each 4-byte aligned
+
+Usage:
+    ./pack_containers.py [-o ../container_store.bin] [files...]
+With no files, every .aot, .wasm and .mem (budget manifest, see
+main/container_budget.h) in ../wasm_assets is packed.
+"""
+import argparse
+import glob
+import os
+import struct
+import sys
+
+MAGIC = 0x524E5443
+VERSION = 1
+NAME_LEN = 32
+PARTITION_SIZE = 256 * 1024  # Keep in sync with partitions.csv
+
+HEADER = struct.Struct("<IHH")
+ENTRY = struct.Struct("<%dsII" % NAME_LEN)
+
+
+def align(value, to=4):
+    return (value + to - 1) & ~(to - 1)
+
+
+def pack(files):
+    offset = align(HEADER.size + ENTRY.size * len(files))
+    table = b""
+    payload = b""
+    for path in files:
+        name = os.path.basename(path).encode()
+        if len(name) >= NAME_LEN:
+            sys.exit("Error: container name too long: %s" % path)
+        with open(path, "rb") as f:
+            data = f.read()
+        table += ENTRY.pack(name, offset + len(payload), len(data))
+        payload += data + b"\0" * (align(len(data)) - len(data))
+
+    image = HEADER.pack(MAGIC, VERSION, len(files)) + table
+    image += b"\0" * (offset - len(image))
+    return image + payload
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", default=os.path.join(here, "..", "container_store.bin"))
+    parser.add_argument("files", nargs="*")
+    args = parser.parse_args()
+
+    files = args.files
+    if not files:
+        assets = os.path.join(here, "..", "wasm_assets")
+        files = sorted(glob.glob(os.path.join(assets, "*.aot")) +
+                       glob.glob(os.path.join(assets, "*.wasm")) +
+                       glob.glob(os.path.join(assets, "*.mem")))
+    if not files:
+        sys.exit("Error: no containers to pack")
+
+    image = pack(files)
+    if len(image) > PARTITION_SIZE:
+        sys.exit("Error: store is %d bytes, partition holds %d" % (len(image), PARTITION_SIZE))
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    for path in files:
+        print("  %-32s %7d bytes" % (os.path.basename(path), os.path.getsize(path)))
+    print("Wrote %s (%d bytes)" % (args.output, len(image)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,54 @@
+#include "container_abi.h"
+#include "signal_filter.h"
+
+// PI temperature controller with proportional heater drive. Unlike the
+// bang-bang controller.c it settles on the duty that holds the setpoint
+// instead of cycling the heater around it.
+
+// Control parameters
+#define TARGET_TEMP  50.0f   // Target temperature in Celsius
+#define KP           0.5f    // Duty per degree of error
+#define KI           0.005f  // Duty per degree-second of accumulated error
+#define SPIKE_WINDOW 3       // Median-of-3 ahead of the loop
+
+static container_io_t *io = 0;
+static sf_median_f32_t spike_filter;
+static float integral = 0.0f; // Duty contributed by the I term
+
+CONTAINER_EXPORT(init)
+void init(void)
+{
+    host_log("PI Temperature Controller Started");
+    host_log("Target: 50C, proportional heater duty");
+
+    io = host_io_window();
+    integral = 0.0f;
+    sf_median_f32_init(&spike_filter, SPIKE_WINDOW, TARGET_TEMP);
+    host_set_heater_duty(0.0f);
+}
+
+static void set_duty(float duty)
+{
+    if (io)
+        container_io_set(io, CONTAINER_IO_HEATER, duty);
+    else
+        host_set_heater_duty(duty);
+}
+
+// Called by the host once per control period
+CONTAINER_EXPORT(step)
+void step(float dt)
+{
+    float temp = io ? io->sensors[CONTAINER_IO_TEMPERATURE] : host_get_temperature();
+    sf_median_f32(&spike_filter, &temp, &temp, 1);
+
+    float error = TARGET_TEMP - temp;
+    float p = KP * error;
+    float duty = p + integral + KI * error * dt;
+
+    // Anti-windup: only integrate while the output is not saturated
+    if (duty > 0.0f && duty < 1.0f)
+        integral += KI * error * dt;
+
+    set_duty(duty);
+}
@@ -0,0 +1,228 @@
+#include <math.h>
+#include "adc_acquire.h"
+#include "adc_decimator.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sim_trace.h"
+
+#define TAG "ADC_ACQ"
+
+#define FRAME_BYTES      (ADC_ACQUIRE_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES)
+#define POOL_FRAMES      4     // DMA pool: frames buffered before overflow
+#define MAX_WINDOWS      16    // Per frame: needs sample_hz / output_hz >= 32
+#define RAW_FULL_SCALE   4095
+#define FALLBACK_FULL_MV 3100  // ADC_ATTEN_DB_12 span when there is no eFuse calibration
+
+static adc_acquire_config_t cfg;
+static adc_continuous_handle_t adc = NULL;
+static adc_cali_handle_t cali = NULL;
+static TaskHandle_t acquire_task_handle = NULL;
+static adc_decimator_t decimator;
+
+static uint32_t windows_published = 0;
+static volatile uint32_t overflows = 0;
+static sim_stage_t stage;
+
+// ============================================================================
+// CALIBRATION
+// ============================================================================
+
+static float raw_to_mv(int raw)
+{
+    int mv;
+    if (cali && adc_cali_raw_to_voltage(cali, raw, &mv) == ESP_OK)
+        return (float)mv;
+    return (float)raw * FALLBACK_FULL_MV / RAW_FULL_SCALE;
+}
+
+// Oversampled means carry fractional counts: interpolate between the
+// calibration points around them. *slope gets mV per count there.
+static float counts_to_mv(float counts, float *slope)
+{
+    int lo = (int)floorf(counts);
+    if (lo < 0)
+        lo = 0;
+    if (lo >= RAW_FULL_SCALE)
+        lo = RAW_FULL_SCALE - 1;
+    float mv_lo = raw_to_mv(lo);
+    float mv_hi = raw_to_mv(lo + 1);
+    if (slope)
+        *slope = mv_hi - mv_lo;
+    return mv_lo + (counts - (float)lo) * (mv_hi - mv_lo);
+}
+
+static void calibration_init(void)
+{
+    adc_cali_line_fitting_config_t cali_config = {
+        .unit_id = cfg.unit,
+        .atten = cfg.atten,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    esp_err_t ret = adc_cali_create_scheme_line_fitting(&cali_config, &cali);
+    if (ret == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Calibration Success");
+    }
+    else
+    {
+        cali = NULL;
+        ESP_LOGW(TAG, "No eFuse calibration (%s), assuming a linear %d mV span",
+                 esp_err_to_name(ret), FALLBACK_FULL_MV);
+    }
+}
+
+// ============================================================================
+// ACQUISITION
+// ============================================================================
+
+static bool IRAM_ATTR on_conv_done(adc_continuous_handle_t handle,
+                                   const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(acquire_task_handle, &woken);
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR on_pool_ovf(adc_continuous_handle_t handle,
+                                  const adc_continuous_evt_data_t *edata, void *user_data)
+{
+    overflows++;
+    return false;
+}
+
+static void publish(const adc_window_t *w, int64_t timestamp_us)
+{
+    float slope;
+    float mean = counts_to_mv(w->mean, &slope) * cfg.units_per_mv;
+    float unit_per_count = slope * cfg.units_per_mv;
+
+    if (cfg.mean)
+        sim_channel_publish(cfg.mean, mean, timestamp_us);
+    if (cfg.min)
+        sim_channel_publish(cfg.min, raw_to_mv(w->min) * cfg.units_per_mv, timestamp_us);
+    if (cfg.max)
+        sim_channel_publish(cfg.max, raw_to_mv(w->max) * cfg.units_per_mv, timestamp_us);
+    if (cfg.variance)
+        sim_channel_publish(cfg.variance, w->variance * unit_per_count * unit_per_count,
+                            timestamp_us);
+
+    sim_trace(SIM_TRACE_ADC_SAMPLE, (uint16_t)(w->mean + 0.5f), mean);
+    windows_published++;
+}
+
+static void acquire_task(void *arg)
+{
+    static uint8_t frame[FRAME_BYTES];
+    static uint16_t raw[ADC_ACQUIRE_FRAME_SAMPLES];
+    static adc_window_t windows[MAX_WINDOWS];
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        sim_stage_activate(&stage);
+
+        // Drain every completed frame; a notification may cover several
+        uint32_t len = 0;
+        while (adc_continuous_read(adc, frame, sizeof(frame), &len, 0) == ESP_OK)
+        {
+            int64_t now = esp_timer_get_time();
+
+            // ESP32 DMA results are TYPE1: 12-bit data + 4-bit channel
+            uint32_t n = 0;
+            for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES)
+            {
+                const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&frame[i];
+                if (p->type1.channel == cfg.channel)
+                {
+                    raw[n++] = p->type1.data;
+                }
+            }
+
+            uint32_t count = adc_decimator_feed(&decimator, raw, n, windows, MAX_WINDOWS);
+            for (uint32_t w = 0; w < count; w++)
+            {
+                publish(&windows[w], now);
+            }
+            if (count && cfg.on_published)
+            {
+                cfg.on_published(cfg.on_published_arg);
+            }
+        }
+    }
+}
+
+bool adc_acquire_start(const adc_acquire_config_t *config)
+{
+    cfg = *config;
+    uint32_t factor = cfg.output_hz ? cfg.sample_hz / cfg.output_hz : 0;
+    if (factor == 0 || ADC_ACQUIRE_FRAME_SAMPLES / factor + 1 > MAX_WINDOWS)
+    {
+        ESP_LOGE(TAG, "Invalid rates: %lu Hz sampled, %lu Hz out",
+                 (unsigned long)cfg.sample_hz, (unsigned long)cfg.output_hz);
+        return false;
+    }
+    adc_decimator_init(&decimator, factor);
+    calibration_init();
+
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = FRAME_BYTES * POOL_FRAMES,
+        .conv_frame_size = FRAME_BYTES,
+    };
+    ESP_ERROR_CHECK(adc_continuous_new_handle(&handle_cfg, &adc));
+
+    adc_digi_pattern_config_t pattern = {
+        .atten = cfg.atten,
+        .channel = cfg.channel,
+        .unit = cfg.unit,
+        .bit_width = ADC_BITWIDTH_12,
+    };
+    adc_continuous_config_t dig_cfg = {
+        .pattern_num = 1,
+        .adc_pattern = &pattern,
+        .sample_freq_hz = cfg.sample_hz,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(adc, &dig_cfg));
+
+    sim_stage_init(&stage, "adc_acquire",
+                   (uint32_t)((uint64_t)ADC_ACQUIRE_FRAME_SAMPLES * 1000000 / cfg.sample_hz));
+    if (xTaskCreatePinnedToCore(acquire_task, "adc_acquire", 4096, NULL, ADC_ACQUIRE_TASK_PRIO,
+                                &acquire_task_handle, SIM_CORE_IO) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create acquisition task");
+        return false;
+    }
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = on_conv_done,
+        .on_pool_ovf = on_pool_ovf,
+    };
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc, &cbs, NULL));
+    ESP_ERROR_CHECK(adc_continuous_start(adc));
+
+    ESP_LOGI(TAG, "Sampling at %lu Hz, %lu samples per window (%lu Hz out)",
+             (unsigned long)cfg.sample_hz, (unsigned long)decimator.factor,
+             (unsigned long)cfg.output_hz);
+    return true;
+}
+
+uint32_t adc_acquire_windows(void)
+{
+    return windows_published;
+}
+
+uint32_t adc_acquire_overflows(void)
+{
+    return overflows;
+}
+
+const sim_stage_t *adc_acquire_stage(void)
+{
+    return &stage;
+}
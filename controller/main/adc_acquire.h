@@ -0,0 +1,46 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_adc/adc_continuous.h"
+#include "sim_pipeline.h"
+#include "sim_state.h"
+
+// Continuous (DMA) ADC acquisition. The ADC digital controller samples one
+// channel at kHz rates into DMA frames; a task woken per frame decimates
+// them (adc_decimator.h) and publishes, per window, the calibrated mean plus
+// min, max and variance to sim_state channels. Readers always see the latest
+// filtered value lock-free, instead of one noisy oneshot sample.
+
+#define ADC_ACQUIRE_FRAME_SAMPLES 512 // Conversions per DMA frame
+#define ADC_ACQUIRE_TASK_PRIO     SIM_PRIO_ACQUIRE // Pinned to SIM_CORE_IO: DMA must not overflow
+
+typedef struct {
+    adc_unit_t unit;
+    adc_channel_t channel;
+    adc_atten_t atten;
+    uint32_t sample_hz;       // Raw conversion rate (ESP32: 20 kHz .. 2 MHz)
+    uint32_t output_hz;       // Windows per second; sample_hz / output_hz samples each
+    float units_per_mv;       // Published value = calibrated mV * units_per_mv
+
+    // Published every window, stamped with the frame arrival time. NULL to skip.
+    sim_channel_t *mean;
+    sim_channel_t *min;
+    sim_channel_t *max;
+    sim_channel_t *variance;  // In published units squared
+
+    // Called from the acquisition task after each DMA frame that published
+    // windows, e.g. control_executor_notify() for on-sample containers.
+    // NULL to skip.
+    void (*on_published)(void *arg);
+    void *on_published_arg;
+} adc_acquire_config_t;
+
+// Start sampling. The config is copied.
+bool adc_acquire_start(const adc_acquire_config_t *config);
+
+// Windows published and DMA frames lost to overflow so far
+uint32_t adc_acquire_windows(void);
+uint32_t adc_acquire_overflows(void);
+
+// Wake-up jitter of the acquisition task against the DMA frame period
+const sim_stage_t *adc_acquire_stage(void);
@@ -0,0 +1,76 @@
+#include "adc_decimator.h"
+
+static void window_reset(adc_decimator_t *d)
+{
+    d->n = 0;
+    d->sum = 0;
+    d->sum_sq = 0;
+    d->min = UINT16_MAX;
+    d->max = 0;
+}
+
+void adc_decimator_init(adc_decimator_t *d, uint32_t factor)
+{
+    if (factor < 1)
+        factor = 1;
+    if (factor > ADC_DECIMATOR_MAX_FACTOR)
+        factor = ADC_DECIMATOR_MAX_FACTOR;
+    d->factor = factor;
+    window_reset(d);
+}
+
+static void window_close(const adc_decimator_t *d, adc_window_t *w)
+{
+    // Exact integer variance: (n * sum_sq - sum^2) / n^2
+    uint64_t n = d->n;
+    uint64_t spread = n * d->sum_sq - (uint64_t)d->sum * d->sum;
+
+    w->mean = (float)d->sum / (float)n;
+    w->variance = (float)((double)spread / (double)(n * n));
+    w->min = d->min;
+    w->max = d->max;
+}
+
+uint32_t adc_decimator_feed(adc_decimator_t *d, const uint16_t *samples, uint32_t count,
+                            adc_window_t *out, uint32_t max_out)
+{
+    uint32_t windows = 0;
+
+    while (count > 0)
+    {
+        uint32_t take = d->factor - d->n;
+        if (take > count)
+            take = count;
+
+        // Accumulate in locals so the loop stays in registers
+        uint32_t sum = 0;
+        uint64_t sum_sq = 0;
+        uint16_t lo = d->min;
+        uint16_t hi = d->max;
+        for (uint32_t i = 0; i < take; i++)
+        {
+            uint32_t s = samples[i];
+            sum += s;
+            sum_sq += s * s;
+            lo = s < lo ? s : lo;
+            hi = s > hi ? s : hi;
+        }
+        d->sum += sum;
+        d->sum_sq += sum_sq;
+        d->min = lo;
+        d->max = hi;
+        d->n += take;
+        samples += take;
+        count -= take;
+
+        if (d->n == d->factor)
+        {
+            if (windows < max_out)
+            {
+                window_close(d, &out[windows++]);
+            }
+            window_reset(d);
+        }
+    }
+    return windows;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+
+// Decimation kernel for continuous ADC acquisition (adc_acquire.c). Raw
+// samples arrive in DMA-sized blocks of any length; every `factor` samples
+// close a window reduced to its mean (oversampled: fractional counts, so
+// averaging N samples adds log4(N) bits of resolution on white noise),
+// min, max and variance.
+//
+// Only sums and extremes are kept per window, accumulated in one pass over
+// each block. Pure C, no IDF dependencies: the host build benchmarks and
+// checks it with synthetic blocks (host/bench/adc_decim_bench.c).
+
+#define ADC_DECIMATOR_MAX_FACTOR 65536 // Keeps the variance sums within 64 bits
+
+typedef struct {
+    uint32_t factor;  // Raw samples per window
+    uint32_t n;       // Samples in the current window
+    uint32_t sum;
+    uint64_t sum_sq;
+    uint16_t min;
+    uint16_t max;
+} adc_decimator_t;
+
+typedef struct {
+    float mean;       // Raw counts
+    float variance;   // Population variance, counts^2
+    uint16_t min;
+    uint16_t max;
+} adc_window_t;
+
+// factor is clamped to 1..ADC_DECIMATOR_MAX_FACTOR
+void adc_decimator_init(adc_decimator_t *d, uint32_t factor);
+
+// Feed a block of 12-bit samples. Completed windows are written to `out`
+// (size it count / factor + 1); any beyond max_out are dropped. Returns the
+// number written.
+uint32_t adc_decimator_feed(adc_decimator_t *d, const uint16_t *samples, uint32_t count,
+                            adc_window_t *out, uint32_t max_out);
@@ -0,0 +1,202 @@
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "container_budget.h"
+#include "container_loader.h"
+#include "container_store.h"
+#include "esp_log.h"
+
+#define TAG "BUDGET"
+
+#define MANIFEST_MAX_SIZE 1024
+#define MANIFEST_LINE_LEN 80
+
+typedef struct {
+    const char *key;
+    size_t offset;
+} budget_key_t;
+
+static const budget_key_t budget_keys[] = {
+    {"wasm_stack", offsetof(container_budget_t, wasm_stack)},
+    {"app_heap", offsetof(container_budget_t, app_heap)},
+    {"max_pages", offsetof(container_budget_t, max_pages)},
+    {"native_stack", offsetof(container_budget_t, native_stack)},
+    {"step_instructions", offsetof(container_budget_t, step_instructions)},
+    {"step_deadline_us", offsetof(container_budget_t, step_deadline_us)},
+    {"step_on_sample", offsetof(container_budget_t, step_on_sample)},
+};
+
+void container_budget_default(container_budget_t *budget)
+{
+    budget->wasm_stack = CONTAINER_EXEC_STACK_SIZE;
+    budget->app_heap = CONTAINER_HEAP_SIZE;
+    budget->max_pages = 0;
+    budget->native_stack = 0;
+    budget->step_instructions = 0;
+    budget->step_deadline_us = 0;
+    budget->step_on_sample = 0;
+}
+
+// ============================================================================
+// MANIFEST
+// ============================================================================
+
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s))
+        s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        end--;
+    *end = '\0';
+    return s;
+}
+
+// One "key=value" line; blank and comment-only lines are fine
+static bool parse_line(char *line, container_budget_t *budget)
+{
+    char *hash = strchr(line, '#');
+    if (hash)
+        *hash = '\0';
+    line = trim(line);
+    if (*line == '\0')
+        return true;
+
+    char *eq = strchr(line, '=');
+    if (!eq)
+    {
+        ESP_LOGW(TAG, "Manifest line without '=': %s", line);
+        return false;
+    }
+    *eq = '\0';
+    const char *key = trim(line);
+    const char *value = trim(eq + 1);
+
+    char *end;
+    unsigned long v = strtoul(value, &end, 0);
+    if (*value == '\0' || *end != '\0' || v > UINT32_MAX)
+    {
+        ESP_LOGW(TAG, "Manifest %s: bad value '%s'", key, value);
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(budget_keys) / sizeof(budget_keys[0]); i++)
+    {
+        if (strcmp(key, budget_keys[i].key) == 0)
+        {
+            *(uint32_t *)((uint8_t *)budget + budget_keys[i].offset) = (uint32_t)v;
+            return true;
+        }
+    }
+    ESP_LOGW(TAG, "Manifest: unknown key '%s'", key);
+    return false;
+}
+
+bool container_budget_parse(const char *text, uint32_t len, container_budget_t *budget)
+{
+    char line[MANIFEST_LINE_LEN];
+    bool ok = true;
+    uint32_t pos = 0;
+
+    while (pos < len)
+    {
+        uint32_t n = 0;
+        while (pos < len && text[pos] != '\n')
+        {
+            if (n < sizeof(line) - 1)
+                line[n++] = text[pos];
+            pos++;
+        }
+        pos++; // Newline
+        line[n] = '\0';
+        ok &= parse_line(line, budget);
+    }
+    return ok;
+}
+
+bool container_budget_load(const char *name, container_budget_t *budget)
+{
+    char path[CONTAINER_PATH_LEN];
+    char text[MANIFEST_MAX_SIZE];
+    const uint8_t *entry = NULL;
+    uint32_t size = 0;
+
+    container_budget_default(budget);
+
+    if (!container_loader_path(path, sizeof(path), name, CONTAINER_BUDGET_EXT))
+    {
+        return false;
+    }
+    // Store entries are the file names; the directory path is longer
+    const char *file = path + strlen(container_loader_dir()) + 1;
+    if (container_store_is_open() && container_store_find(file, &entry, &size))
+    {
+        container_budget_parse((const char *)entry, size, budget);
+        ESP_LOGI(TAG, "%s: budget from container store", name);
+        return true;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        return false;
+    }
+    size = (uint32_t)fread(text, 1, sizeof(text), f);
+    fclose(f);
+    container_budget_parse(text, size, budget);
+    ESP_LOGI(TAG, "%s: budget from %s", name, path);
+    return true;
+}
+
+bool container_budget_write(const char *path, const container_budget_t *budget,
+                            const char *comment)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        ESP_LOGE(TAG, "Cannot write %s", path);
+        return false;
+    }
+
+    while (comment && *comment)
+    {
+        const char *nl = strchr(comment, '\n');
+        int n = nl ? (int)(nl - comment) : (int)strlen(comment);
+        fprintf(f, "# %.*s\n", n, comment);
+        comment += n + (nl ? 1 : 0);
+    }
+    fprintf(f, "wasm_stack=%lu\n", (unsigned long)budget->wasm_stack);
+    fprintf(f, "app_heap=%lu\n", (unsigned long)budget->app_heap);
+    fprintf(f, "max_pages=%lu\n", (unsigned long)budget->max_pages);
+    fprintf(f, "native_stack=%lu\n", (unsigned long)budget->native_stack);
+    fprintf(f, "step_instructions=%lu\n", (unsigned long)budget->step_instructions);
+    fprintf(f, "step_deadline_us=%lu\n", (unsigned long)budget->step_deadline_us);
+    fprintf(f, "step_on_sample=%lu\n", (unsigned long)budget->step_on_sample);
+    return fclose(f) == 0;
+}
+
+// ============================================================================
+// INSTANTIATION
+// ============================================================================
+
+wasm_module_inst_t container_budget_instantiate(wasm_module_t module,
+                                                const container_budget_t *budget,
+                                                char *error_buf, uint32_t error_buf_size)
+{
+    // The executor creates its own exec env, so the default stack only
+    // matters to exec envs WAMR creates internally: give it the same budget
+    InstantiationArgs args = {
+        .default_stack_size = budget->wasm_stack,
+        .host_managed_heap_size = budget->app_heap,
+        .max_memory_pages = budget->max_pages,
+    };
+    return wasm_runtime_instantiate_ex(module, &args, error_buf, error_buf_size);
+}
+
+wasm_exec_env_t container_budget_exec_env(wasm_module_inst_t module_inst,
+                                          const container_budget_t *budget)
+{
+    return wasm_runtime_create_exec_env(module_inst, budget->wasm_stack);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "wasm_export.h"
+
+// Per-container memory budgets, read from a manifest "<name>.mem" kept next
+// to the container image (container store entry or file in the container
+// directory). Containers without one get the defaults below, which is what
+// every container got before manifests existed.
+//
+// The manifest is plain "key=value" lines, '#' starts a comment, and any key
+// left out keeps its default:
+//
+//   wasm_stack=1024     WASM stack of the exec env: operand stack + frames
+//   app_heap=512        App heap in linear memory (I/O window, module_malloc)
+//   max_pages=1         Cap on linear memory growth, 0 = the module's own max
+//   native_stack=8192   Instance thread stack (container_manager), 0 = default
+//   step_instructions=0 WASM instructions one step() may execute, 0 = no limit
+//   step_deadline_us=0  Wall time one step() may take, 0 = its period
+//   step_on_sample=0    1 = step when a sensor sample arrives, the period
+//                       only as a timeout; 0 = step every period
+//
+// Linear memory itself is sized by the module: built with the size profile
+// (containers/create_container.bash), WAMR shrinks it to data + shadow stack
+// at load. sim_lockstep -P measures a run and writes a tight manifest.
+//
+// The step budgets are enforced by the executor (control_executor.h): a step
+// over either one is cut short and counted. step_on_sample picks how the
+// executor triggers steps (see control_executor_run).
+
+#define CONTAINER_BUDGET_EXT ".mem"
+
+// Defaults, for containers without a manifest
+#define CONTAINER_HEAP_SIZE       (16 * 1024) // WASM app heap (malloc in WASM)
+#define CONTAINER_EXEC_STACK_SIZE (8 * 1024)  // WASM stack of the exec env (not a native stack)
+
+typedef struct {
+    uint32_t wasm_stack;        // Exec env WASM stack (bytes)
+    uint32_t app_heap;          // App heap (bytes)
+    uint32_t max_pages;         // Linear memory page cap, 0 = module's
+    uint32_t native_stack;      // Instance thread stack (bytes), 0 = platform default
+    uint32_t step_instructions; // Per-step instruction limit, 0 = none
+    uint32_t step_deadline_us;  // Per-step wall-time limit, 0 = the period
+    uint32_t step_on_sample;    // Event-driven stepping (control_executor_notify)
+} container_budget_t;
+
+void container_budget_default(container_budget_t *budget);
+
+// Apply the "key=value" lines of `text` (`len` bytes, need not be NUL
+// terminated) over `budget`. Unknown keys and bad values are logged and
+// skipped. Returns false if any line was skipped.
+bool container_budget_parse(const char *text, uint32_t len, container_budget_t *budget);
+
+// Defaults overridden by container `name`'s manifest: the container store
+// entry first, then the file in the container directory. Returns true if a
+// manifest was found.
+bool container_budget_load(const char *name, container_budget_t *budget);
+
+// Write `budget` as a manifest, with `comment` (may be NULL, may span lines)
+// as '#' lines on top
+bool container_budget_write(const char *path, const container_budget_t *budget,
+                            const char *comment);
+
+// wasm_runtime_instantiate() within `budget`, and the matching exec env
+wasm_module_inst_t container_budget_instantiate(wasm_module_t module,
+                                                const container_budget_t *budget,
+                                                char *error_buf, uint32_t error_buf_size);
+wasm_exec_env_t container_budget_exec_env(wasm_module_inst_t module_inst,
+                                          const container_budget_t *budget);
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "container_loader.h"
+#include "container_store.h"
+#include "esp_log.h"
+
+#define TAG "LOADER"
+
+static const char *container_dir = CONTAINER_DIR_DEFAULT;
+
+void container_loader_set_dir(const char *dir)
+{
+    container_dir = dir;
+}
+
+const char *container_loader_dir(void)
+{
+    return container_dir;
+}
+
+bool container_loader_path(char *path, size_t len, const char *name, const char *ext)
+{
+    int n = snprintf(path, len, "%s/%s%s", container_dir, name, ext);
+    if (n < 0 || (size_t)n >= len)
+    {
+        ESP_LOGE(TAG, "Path too long: %s/%s%s", container_dir, name, ext);
+        return false;
+    }
+    return true;
+}
+
+uint8_t *load_wasm_from_spiffs(const char *filename, uint32_t *size)
+{
+    ESP_LOGI(TAG, "Opening file: %s", filename);
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+    {
+        ESP_LOGE(TAG, "Failed to open file");
+        return NULL;
+    }
+
+    long fsize = -1;
+    if (fseek(f, 0, SEEK_END) == 0)
+    {
+        fsize = ftell(f);
+    }
+    if (fsize <= 0 || fseek(f, 0, SEEK_SET) != 0)
+    {
+        ESP_LOGE(TAG, "Failed to get file size");
+        fclose(f);
+        return NULL;
+    }
+
+    uint8_t *buffer = malloc(fsize);
+    if (!buffer)
+    {
+        ESP_LOGE(TAG, "Malloc failed");
+        fclose(f);
+        return NULL;
+    }
+
+    size_t got = fread(buffer, 1, fsize, f);
+    fclose(f);
+    if (got != (size_t)fsize)
+    {
+        ESP_LOGE(TAG, "Short read: %u of %ld bytes", (unsigned)got, fsize);
+        free(buffer);
+        return NULL;
+    }
+    *size = (uint32_t)fsize;
+    return buffer;
+}
+
+// Check that an image is an AOT file this runtime can execute. wamrc stamps
+// every .aot with a format version; a stale image built by an older wamrc is
+// rejected here instead of failing half-way through wasm_runtime_load.
+static bool is_compatible_aot(uint8_t *buffer, uint32_t size)
+{
+    if (get_package_type(buffer, size) != Wasm_Module_AoT)
+    {
+        ESP_LOGW(TAG, "Not an AOT image");
+        return false;
+    }
+
+    uint32_t version = wasm_runtime_get_file_package_version(buffer, size);
+    uint32_t expected = wasm_runtime_get_current_package_version(Wasm_Module_AoT);
+    if (version != expected)
+    {
+        ESP_LOGW(TAG, "AOT image version %lu, runtime expects %lu",
+                 (unsigned long)version, (unsigned long)expected);
+        return false;
+    }
+    return true;
+}
+
+// The classic interpreter rewrites opcodes inside the bytecode buffer while
+// loading, so it cannot run bytecode straight out of read-only flash. The
+// fast interpreter only writes to it when it keeps referring to the buffer
+// (const strings are moved in place): loaded as freeable, it copies what it
+// keeps and only reads the image. AOT images are only read by the loader.
+#ifdef CONFIG_WAMR_INTERP_CLASSIC
+#define BYTECODE_NEEDS_RAM_COPY 1
+#else
+#define BYTECODE_NEEDS_RAM_COPY 0
+#endif
+
+// Load a container from the memory-mapped container store. AOT images run in
+// place; bytecode is parsed straight from the mapping (the fast interpreter
+// builds its own code copy), or from a heap copy for the classic interpreter
+// (returned in *buffer, NULL otherwise).
+static wasm_module_t load_container_from_store(const char *name, uint8_t **buffer)
+{
+    char entry[CONTAINER_NAME_LEN];
+    char error_buf[128];
+    const uint8_t *image = NULL;
+    uint32_t size = 0;
+    wasm_module_t module = NULL;
+
+    snprintf(entry, sizeof(entry), "%s.aot", name);
+    if (container_store_find(entry, &image, &size) && is_compatible_aot((uint8_t *)image, size))
+    {
+        module = wasm_runtime_load((uint8_t *)image, size, error_buf, sizeof(error_buf));
+        if (module)
+        {
+            ESP_LOGI(TAG, "Loaded AOT container %s in place from flash", entry);
+            return module;
+        }
+        ESP_LOGW(TAG, "AOT load failed: %s", error_buf);
+    }
+
+    snprintf(entry, sizeof(entry), "%s.wasm", name);
+    if (!container_store_find(entry, &image, &size))
+    {
+        return NULL;
+    }
+
+    uint8_t *bytecode = (uint8_t *)image;
+    if (BYTECODE_NEEDS_RAM_COPY)
+    {
+        bytecode = malloc(size);
+        if (!bytecode)
+        {
+            ESP_LOGE(TAG, "Malloc failed");
+            return NULL;
+        }
+        memcpy(bytecode, image, size);
+    }
+
+    LoadArgs args = {.name = entry, .wasm_binary_freeable = !BYTECODE_NEEDS_RAM_COPY};
+    module = wasm_runtime_load_ex(bytecode, size, &args, error_buf, sizeof(error_buf));
+    if (!module)
+    {
+        ESP_LOGE(TAG, "WASM load failed: %s", error_buf);
+        if (BYTECODE_NEEDS_RAM_COPY)
+        {
+            free(bytecode);
+        }
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Loaded bytecode container %s from store%s", entry,
+             BYTECODE_NEEDS_RAM_COPY ? " (RAM copy)" : ", read in place");
+    *buffer = BYTECODE_NEEDS_RAM_COPY ? bytecode : NULL;
+    return module;
+}
+
+// Load a container by base name. The raw container store is tried first;
+// otherwise the container directory (SPIFFS) is used.
+// Any heap buffer backing the module must outlive it, so it is returned in
+// *buffer (NULL when the module runs from mapped flash).
+wasm_module_t load_container(const char *name, uint8_t **buffer)
+{
+    *buffer = NULL;
+
+    if (container_store_is_open())
+    {
+        wasm_module_t module = load_container_from_store(name, buffer);
+        if (module)
+        {
+            return module;
+        }
+        ESP_LOGW(TAG, "%s not in container store, trying %s", name, container_dir);
+    }
+    return load_container_from_dir(name, buffer);
+}
+
+// Prefer the AOT-compiled "<name>.aot", falling back to interpreting
+// "<name>.wasm" when the AOT image is missing, built for another runtime
+// version or rejected by the loader.
+wasm_module_t load_container_from_dir(const char *name, uint8_t **buffer)
+{
+    char path[CONTAINER_PATH_LEN];
+    char error_buf[128];
+    uint32_t size = 0;
+    wasm_module_t module = NULL;
+
+    *buffer = NULL;
+
+    // Shipping only bytecode is normal, so a missing .aot is not an error
+    uint8_t *aot_file = NULL;
+    struct stat st;
+    if (container_loader_path(path, sizeof(path), name, ".aot"))
+    {
+        if (stat(path, &st) == 0)
+        {
+            aot_file = load_wasm_from_spiffs(path, &size);
+        }
+        else
+        {
+            ESP_LOGI(TAG, "No AOT image %s", path);
+        }
+    }
+    if (aot_file)
+    {
+        if (is_compatible_aot(aot_file, size))
+        {
+            module = wasm_runtime_load(aot_file, size, error_buf, sizeof(error_buf));
+            if (module)
+            {
+                ESP_LOGI(TAG, "Loaded AOT container %s", path);
+                *buffer = aot_file;
+                return module;
+            }
+            ESP_LOGW(TAG, "AOT load failed: %s", error_buf);
+        }
+        free(aot_file);
+    }
+
+    ESP_LOGI(TAG, "Falling back to interpreter");
+    if (!container_loader_path(path, sizeof(path), name, ".wasm"))
+    {
+        return NULL;
+    }
+    uint8_t *wasm_file = load_wasm_from_spiffs(path, &size);
+    if (!wasm_file)
+    {
+        return NULL;
+    }
+
+    module = wasm_runtime_load(wasm_file, size, error_buf, sizeof(error_buf));
+    if (!module)
+    {
+        ESP_LOGE(TAG, "WASM load failed: %s", error_buf);
+        free(wasm_file);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Loaded bytecode container %s", path);
+    *buffer = wasm_file;
+    return module;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "wasm_export.h"
+
+// Finds and loads control containers: from the memory-mapped container store
+// when one is open (see container_store.h), otherwise from files in the
+// container directory, preferring AOT images over bytecode.
+
+#define CONTAINER_DIR_DEFAULT "/spiffs"
+
+// Directory searched for <name>.aot / <name>.wasm files. The string must
+// stay valid; defaults to the SPIFFS mount point.
+void container_loader_set_dir(const char *dir);
+const char *container_loader_dir(void);
+
+// Container paths are built into fixed buffers
+#define CONTAINER_PATH_LEN 128
+
+// Write "<dir>/<name><ext>" to `path`. Returns false, and logs, if it does
+// not fit in `len` bytes: a truncated path could open another file.
+bool container_loader_path(char *path, size_t len, const char *name, const char *ext);
+
+// Read a whole file into a heap buffer
+uint8_t *load_wasm_from_spiffs(const char *filename, uint32_t *size);
+
+// Load container `name`. Any heap buffer backing the module is returned in
+// *buffer and must be freed after wasm_runtime_unload (NULL when the module
+// runs straight from mapped flash).
+wasm_module_t load_container(const char *name, uint8_t **buffer);
+
+// Same, from the container directory only: the store is flashed with the
+// firmware and never changes under a running container, so a replacement
+// image can only come from the directory.
+wasm_module_t load_container_from_dir(const char *name, uint8_t **buffer);
@@ -0,0 +1,487 @@
+#if !defined(ESP_PLATFORM) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // pthread_attr_setaffinity_np
+#endif
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "container_manager.h"
+#include "container_budget.h"
+#include "container_loader.h"
+#include "container_store.h"
+#include "control_executor.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sim_pipeline.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#define TAG "MANAGER"
+
+#define INSTANCE_NAME_LEN (CONTAINER_NAME_LEN + 8)
+
+typedef struct {
+    char name[CONTAINER_NAME_LEN];
+    wasm_module_t module;
+    uint8_t *buffer;           // Heap copy backing the module, NULL if mapped
+    uint64_t files_sig;        // Size/mtime of its files, see files_signature()
+    container_budget_t budget; // From <name>.mem, or the defaults
+} managed_module_t;
+
+typedef struct {
+    char name[INSTANCE_NAME_LEN]; // "<module>#<n>"
+    managed_module_t *module;
+    uint32_t period_us;
+    void *user_data;
+    control_container_t *container; // NULL for legacy main() containers
+    atomic_bool running;
+    pthread_t thread;
+} managed_instance_t;
+
+static managed_module_t modules[CONTAINER_MANAGER_MAX_MODULES];
+static int module_count = 0;
+static managed_instance_t instances[CONTAINER_MANAGER_MAX_INSTANCES];
+static int instance_count = 0;
+
+// ============================================================================
+// MODULES
+// ============================================================================
+
+// Strip a .wasm / .aot extension. Returns false for any other file.
+static bool container_base_name(const char *file, char *name, size_t len)
+{
+    const char *dot = strrchr(file, '.');
+    if (!dot || (strcmp(dot, ".wasm") != 0 && strcmp(dot, ".aot") != 0))
+    {
+        return false;
+    }
+    size_t n = (size_t)(dot - file);
+    if (n == 0 || n >= len)
+    {
+        return false;
+    }
+    memcpy(name, file, n);
+    name[n] = '\0';
+    return true;
+}
+
+// Size and mtime of <dir>/<name>.aot, <dir>/<name>.wasm and its manifest,
+// to notice a container image or budget being replaced on disk. 0 when none
+// of the files exists.
+static uint64_t files_signature(const char *name)
+{
+    static const char *const exts[] = {".aot", ".wasm", CONTAINER_BUDGET_EXT};
+    char path[CONTAINER_PATH_LEN];
+    uint64_t sig = 0;
+
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++)
+    {
+        struct stat st;
+        if (container_loader_path(path, sizeof(path), name, exts[i]) && stat(path, &st) == 0)
+        {
+            sig = sig * 31 + (((uint64_t)st.st_size << 32) ^ (uint64_t)st.st_mtime);
+        }
+    }
+    return sig;
+}
+
+static managed_module_t *find_module(const char *name)
+{
+    for (int i = 0; i < module_count; i++)
+    {
+        if (strcmp(modules[i].name, name) == 0)
+        {
+            return &modules[i];
+        }
+    }
+    return NULL;
+}
+
+// Load `file`'s container unless a module of that name is already loaded.
+// load_container() picks the best image (store before files, AOT before
+// bytecode), so "x.aot" and "x.wasm" yield one module.
+static void load_once(const char *file)
+{
+    char name[CONTAINER_NAME_LEN];
+    if (!container_base_name(file, name, sizeof(name)) || container_manager_module(name))
+    {
+        return;
+    }
+    if (module_count == CONTAINER_MANAGER_MAX_MODULES)
+    {
+        ESP_LOGW(TAG, "Module table full, skipping %s", name);
+        return;
+    }
+
+    managed_module_t *m = &modules[module_count];
+    m->module = load_container(name, &m->buffer);
+    if (!m->module)
+    {
+        ESP_LOGE(TAG, "Failed to load %s", name);
+        return;
+    }
+    strcpy(m->name, name);
+    m->files_sig = files_signature(name);
+    container_budget_load(name, &m->budget);
+    module_count++;
+}
+
+int container_manager_load_all(void)
+{
+    char entry[CONTAINER_NAME_LEN + 1];
+    for (uint16_t i = 0; i < container_store_count(); i++)
+    {
+        if (container_store_name(i, entry))
+        {
+            load_once(entry);
+        }
+    }
+
+    DIR *dir = opendir(container_loader_dir());
+    if (dir)
+    {
+        struct dirent *de;
+        while ((de = readdir(dir)) != NULL)
+        {
+            load_once(de->d_name);
+        }
+        closedir(dir);
+    }
+    else
+    {
+        ESP_LOGW(TAG, "Cannot open %s", container_loader_dir());
+    }
+
+    ESP_LOGI(TAG, "%d container module(s) loaded", module_count);
+    return module_count;
+}
+
+wasm_module_t container_manager_module(const char *name)
+{
+    managed_module_t *m = find_module(name);
+    return m ? m->module : NULL;
+}
+
+void container_manager_unload_all(void)
+{
+    for (int i = 0; i < module_count; i++)
+    {
+        wasm_runtime_unload(modules[i].module);
+        free(modules[i].buffer);
+    }
+    module_count = 0;
+}
+
+// ============================================================================
+// INSTANCES
+// ============================================================================
+
+static void *instance_thread(void *arg)
+{
+    managed_instance_t *inst = arg;
+
+    // Threads not created by WAMR must set up their runtime thread env
+    if (wasm_runtime_init_thread_env())
+    {
+        if (inst->container)
+        {
+            control_executor_run(inst->container);
+            control_container_report(inst->container);
+        }
+        else
+        {
+            control_executor_run_module(inst->module->module, inst->name, &inst->module->budget,
+                                        inst->period_us, inst->user_data);
+        }
+        wasm_runtime_destroy_thread_env();
+    }
+    else
+    {
+        ESP_LOGE(TAG, "%s: thread env init failed", inst->name);
+    }
+    atomic_store(&inst->running, false);
+    return NULL;
+}
+
+// Thread stack of an instance: the manifest's when it has one. Linux keeps
+// at least the default, most of which WAMR's stack guard takes.
+static uint32_t instance_stack_size(const container_budget_t *budget)
+{
+#ifdef ESP_PLATFORM
+    return budget->native_stack ? budget->native_stack : CONTAINER_MANAGER_STACK_SIZE;
+#else
+    return budget->native_stack > CONTAINER_MANAGER_STACK_SIZE ? budget->native_stack
+                                                               : CONTAINER_MANAGER_STACK_SIZE;
+#endif
+}
+
+bool container_manager_spawn(const char *name, uint32_t period_us, int core, void *user_data)
+{
+    managed_module_t *module = find_module(name);
+    if (!module)
+    {
+        ESP_LOGE(TAG, "No module named %s", name);
+        return false;
+    }
+    if (instance_count == CONTAINER_MANAGER_MAX_INSTANCES)
+    {
+        ESP_LOGE(TAG, "Instance table full");
+        return false;
+    }
+
+    managed_instance_t *inst = &instances[instance_count];
+    snprintf(inst->name, sizeof(inst->name), "%s#%d", name, instance_count);
+    inst->module = module;
+    inst->period_us = period_us;
+    inst->user_data = user_data;
+
+    // Step-ABI containers are instantiated (and init() run) here, so the
+    // manager holds the running container and can hot-swap it later
+    inst->container = NULL;
+    if (control_module_has_step(module->module))
+    {
+        inst->container = control_container_prepare(module->module, inst->name,
+                                                    &module->budget, period_us, user_data);
+        if (!inst->container)
+        {
+            ESP_LOGE(TAG, "%s: not started", inst->name);
+            return false;
+        }
+    }
+    atomic_store(&inst->running, true);
+
+    uint32_t stack_size = instance_stack_size(&module->budget);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stack_size);
+
+#ifdef ESP_PLATFORM
+    // esp_pthread_set_cfg() applies to the next pthread_create() of this task
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.stack_size = stack_size;
+    cfg.thread_name = inst->name;
+    cfg.pin_to_core = core >= 0 ? core : instance_count % portNUM_PROCESSORS;
+    cfg.prio = SIM_PRIO_CONTROL;
+    esp_pthread_set_cfg(&cfg);
+#else
+    // Pin only on request, and only to cores that exist
+    if (core >= 0 && core < sysconf(_SC_NPROCESSORS_ONLN))
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+#endif
+
+    int res = pthread_create(&inst->thread, &attr, instance_thread, inst);
+    pthread_attr_destroy(&attr);
+    if (res != 0)
+    {
+        ESP_LOGE(TAG, "%s: failed to create thread: %d", inst->name, res);
+        if (inst->container)
+        {
+            control_container_destroy(inst->container);
+        }
+        return false;
+    }
+
+    ESP_LOGI(TAG, "%s: started, period %lu us | wasm stack %lu B, app heap %lu B, thread stack %lu B",
+             inst->name, (unsigned long)period_us, (unsigned long)module->budget.wasm_stack,
+             (unsigned long)module->budget.app_heap, (unsigned long)stack_size);
+    instance_count++;
+    return true;
+}
+
+void container_manager_join(void)
+{
+    for (int i = 0; i < instance_count; i++)
+    {
+        pthread_join(instances[i].thread, NULL);
+        if (instances[i].container)
+        {
+            control_container_destroy(instances[i].container);
+        }
+    }
+    instance_count = 0;
+}
+
+int container_manager_running(void)
+{
+    int running = 0;
+    for (int i = 0; i < instance_count; i++)
+    {
+        running += atomic_load(&instances[i].running);
+    }
+    return running;
+}
+
+// ============================================================================
+// HOT SWAP
+// ============================================================================
+
+static void sleep_us(uint32_t us)
+{
+#ifdef ESP_PLATFORM
+    vTaskDelay(pdMS_TO_TICKS(us / 1000) + 1);
+#else
+    usleep(us);
+#endif
+}
+
+int container_manager_reload(const char *name)
+{
+    managed_module_t *m = find_module(name);
+    if (!m)
+    {
+        ESP_LOGE(TAG, "No module named %s", name);
+        return -1;
+    }
+
+    // The store never changes while running: new images are files
+    int64_t start = esp_timer_get_time();
+    uint8_t *buffer = NULL;
+    container_budget_t budget;
+    container_budget_load(name, &budget);
+    wasm_module_t module = load_container_from_dir(name, &buffer);
+    if (!module)
+    {
+        ESP_LOGE(TAG, "%s: reload failed, keeping the running version", name);
+        return -1;
+    }
+
+    // Prepare every replacement before offering any, so a failure leaves
+    // all instances on the old version
+    control_container_t *next[CONTAINER_MANAGER_MAX_INSTANCES] = {0};
+    uint32_t swaps[CONTAINER_MANAGER_MAX_INSTANCES];
+    bool ok = true;
+    for (int i = 0; i < instance_count && ok; i++)
+    {
+        managed_instance_t *inst = &instances[i];
+        if (inst->module != m || !atomic_load(&inst->running))
+        {
+            continue;
+        }
+        if (!inst->container)
+        {
+            ESP_LOGE(TAG, "%s: legacy main() container, cannot be swapped", inst->name);
+            ok = false;
+            break;
+        }
+        next[i] = control_container_prepare(module, inst->name, &budget, inst->period_us,
+                                            inst->user_data);
+        ok = next[i] != NULL;
+    }
+    if (!ok)
+    {
+        for (int i = 0; i < instance_count; i++)
+        {
+            if (next[i])
+            {
+                control_container_destroy(next[i]);
+            }
+        }
+        wasm_runtime_unload(module);
+        free(buffer);
+        ESP_LOGE(TAG, "%s: reload aborted, keeping the running version", name);
+        return -1;
+    }
+    uint32_t prepare_us = (uint32_t)(esp_timer_get_time() - start);
+
+    int swapped = 0;
+    for (int i = 0; i < instance_count; i++)
+    {
+        if (!next[i])
+            continue;
+        swaps[i] = atomic_load(&instances[i].container->swaps);
+        if (!control_executor_swap(instances[i].container, next[i]))
+        {
+            control_container_destroy(next[i]);
+            next[i] = NULL;
+        }
+    }
+
+    // Each executor adopts its replacement within one period and retires the
+    // old instance before the next; the old module goes once all have done so
+    bool retired = true;
+    uint32_t worst_wait_us = 0;
+    uint32_t worst_retire_us = 0;
+    for (int i = 0; i < instance_count; i++)
+    {
+        managed_instance_t *inst = &instances[i];
+        if (!next[i])
+        {
+            // Stopped instances keep their container until the join
+            if (inst->module == m && inst->container)
+                retired = false;
+            continue;
+        }
+        while (atomic_load(&inst->container->swaps) == swaps[i] && atomic_load(&inst->running))
+        {
+            sleep_us(inst->period_us / 4);
+        }
+        if (atomic_load(&inst->container->swaps) == swaps[i])
+        {
+            retired = false; // Stopped first: still holds an old instance
+            continue;
+        }
+        swapped++;
+        if (inst->container->last_swap_wait_us > worst_wait_us)
+            worst_wait_us = inst->container->last_swap_wait_us;
+        if (inst->container->last_swap_retire_us > worst_retire_us)
+            worst_retire_us = inst->container->last_swap_retire_us;
+    }
+
+    if (retired)
+    {
+        wasm_runtime_unload(m->module);
+        free(m->buffer);
+    }
+    else
+    {
+        ESP_LOGW(TAG, "%s: a stopped instance still uses the old version, kept loaded", name);
+    }
+    m->module = module;
+    m->buffer = buffer;
+    m->budget = budget; // Thread stacks keep the size they were spawned with
+    m->files_sig = files_signature(name);
+
+    ESP_LOGI(TAG, "%s: %d instance(s) swapped | prepared in %lu us | "
+                  "worst wait for boundary %lu us | worst retire %lu us",
+             name, swapped, (unsigned long)prepare_us, (unsigned long)worst_wait_us,
+             (unsigned long)worst_retire_us);
+    return swapped;
+}
+
+int container_manager_check_updates(void)
+{
+    int reloaded = 0;
+    for (int i = 0; i < module_count; i++)
+    {
+        managed_module_t *m = &modules[i];
+        uint64_t sig = files_signature(m->name);
+        if (sig == m->files_sig || sig == 0)
+        {
+            continue;
+        }
+        // Recorded even if the reload fails: a file still being written
+        // changes again when complete and is retried then
+        m->files_sig = sig;
+        ESP_LOGI(TAG, "%s: changed on disk, reloading", m->name);
+        if (container_manager_reload(m->name) >= 0)
+        {
+            reloaded++;
+        }
+    }
+    return reloaded;
+}
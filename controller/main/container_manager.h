@@ -0,0 +1,63 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "wasm_export.h"
+
+// Multi-tenant container host. Every container image available (entries of
+// the container store and <name>.aot / <name>.wasm files in the container
+// directory) is loaded once, with its memory budgets (<name>.mem, see
+// container_budget.h); any number of instances can then be spawned from a
+// loaded module. Instances share the module's code, but each has its
+// own module instance (linear memory, globals), exec env, period, natives
+// binding and thread, pinned to a core on ESP32.
+//
+// Step-ABI instances can be hot-swapped to a new version of their module
+// without stopping the control loop (see control_executor_swap).
+
+#define CONTAINER_MANAGER_MAX_MODULES   8
+#define CONTAINER_MANAGER_MAX_INSTANCES 8
+#define CONTAINER_MANAGER_ANY_CORE      (-1)
+
+// Native stack of each instance thread, unless the container's manifest
+// (container_budget.h) sets native_stack
+#ifdef ESP_PLATFORM
+#define CONTAINER_MANAGER_STACK_SIZE    (24 * 1024)  // Same as the WAMR pthread in app_main
+#else
+#define CONTAINER_MANAGER_STACK_SIZE    (256 * 1024) // WAMR's Linux stack guard alone needs tens of KiB
+#endif
+
+// Load every container found. Returns the number of modules loaded.
+int container_manager_load_all(void);
+
+// Loaded module `name` (file name without extension), or NULL
+wasm_module_t container_manager_module(const char *name);
+
+// Start an instance of module `name` stepping every period_us in its own
+// thread. `user_data` is attached to its exec env for the natives (e.g. a
+// controller_link binding). With CONTAINER_MANAGER_ANY_CORE, instances are
+// spread round-robin over the cores; the firmware keeps them all on
+// SIM_CORE_CONTROL (sim_pipeline.h). On ESP32 they run at SIM_PRIO_CONTROL.
+bool container_manager_spawn(const char *name, uint32_t period_us, int core, void *user_data);
+
+// Wait until every instance has stopped
+void container_manager_join(void);
+
+// Number of instances still running
+int container_manager_running(void);
+
+// Load container `name` again from the container directory, even if it was
+// first loaded from the container store, and hot-swap every running instance of it to the new version:
+// each replacement is instantiated and init()ed in the calling thread, then
+// takes over at its executor's next period boundary. Blocks until every
+// instance has switched (about one period) and the old module is unloaded.
+// Returns the number of instances swapped, or -1 with the old version left
+// running if the new one cannot be loaded, instantiated or initialized.
+// Not reentrant: call from one thread only.
+int container_manager_reload(const char *name);
+
+// Reload every module whose files in the container directory changed since
+// they were loaded. Returns the number of modules reloaded.
+int container_manager_check_updates(void);
+
+// Unload every module. Only after container_manager_join().
+void container_manager_unload_all(void);
@@ -0,0 +1,185 @@
+#include <string.h>
+#include "container_store.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define TAG "STORE"
+
+static const uint8_t *store_base = NULL;
+static uint32_t store_size = 0;
+
+#ifdef ESP_PLATFORM
+static esp_partition_mmap_handle_t store_mmap_handle;
+#endif
+
+// Validate the header and every entry against the mapped size, so lookups
+// never have to bounds-check again.
+static bool store_is_valid(const uint8_t *base, uint32_t size)
+{
+    const container_store_header_t *hdr = (const container_store_header_t *)base;
+    if (size < sizeof(*hdr) || hdr->magic != CONTAINER_STORE_MAGIC)
+    {
+        ESP_LOGE(TAG, "No container store found (bad magic)");
+        return false;
+    }
+    if (hdr->version != CONTAINER_STORE_VERSION)
+    {
+        ESP_LOGE(TAG, "Unsupported store version %u", hdr->version);
+        return false;
+    }
+
+    uint32_t table_end = sizeof(*hdr) + hdr->count * sizeof(container_store_entry_t);
+    if (table_end > size)
+    {
+        ESP_LOGE(TAG, "Entry table exceeds store size");
+        return false;
+    }
+
+    const container_store_entry_t *entries = (const container_store_entry_t *)(base + sizeof(*hdr));
+    for (uint16_t i = 0; i < hdr->count; i++)
+    {
+        if (entries[i].offset < table_end || entries[i].size > size - entries[i].offset)
+        {
+            ESP_LOGE(TAG, "Entry %u out of bounds", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool container_store_open(const char *source)
+{
+    const void *base = NULL;
+    uint32_t size = 0;
+
+    container_store_close();
+
+#ifdef ESP_PLATFORM
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           CONTAINER_STORE_SUBTYPE, source);
+    if (!part)
+    {
+        ESP_LOGW(TAG, "Partition '%s' not found", source);
+        return false;
+    }
+
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA,
+                                       &base, &store_mmap_handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "mmap of '%s' failed: %s", source, esp_err_to_name(err));
+        return false;
+    }
+    size = part->size;
+#else
+    int fd = open(source, O_RDONLY);
+    if (fd < 0)
+    {
+        ESP_LOGW(TAG, "Store file '%s' not found", source);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        ESP_LOGE(TAG, "mmap of '%s' failed", source);
+        return false;
+    }
+    size = (uint32_t)st.st_size;
+#endif
+
+    store_base = base;
+    store_size = size;
+
+    if (!store_is_valid(store_base, store_size))
+    {
+        container_store_close();
+        return false;
+    }
+
+    const container_store_header_t *hdr = (const container_store_header_t *)store_base;
+    ESP_LOGI(TAG, "Mapped container store '%s' (%u entries) at %p",
+             source, hdr->count, (const void *)store_base);
+    return true;
+}
+
+bool container_store_find(const char *name, const uint8_t **data, uint32_t *size)
+{
+    if (!store_base)
+    {
+        return false;
+    }
+
+    const container_store_header_t *hdr = (const container_store_header_t *)store_base;
+    const container_store_entry_t *entries = (const container_store_entry_t *)(store_base + sizeof(*hdr));
+
+    for (uint16_t i = 0; i < hdr->count; i++)
+    {
+        if (strncmp(entries[i].name, name, CONTAINER_NAME_LEN) == 0)
+        {
+            *data = store_base + entries[i].offset;
+            *size = entries[i].size;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool container_store_is_open(void)
+{
+    return store_base != NULL;
+}
+
+uint16_t container_store_count(void)
+{
+    if (!store_base)
+    {
+        return 0;
+    }
+    return ((const container_store_header_t *)store_base)->count;
+}
+
+bool container_store_name(uint16_t index, char name[CONTAINER_NAME_LEN + 1])
+{
+    if (index >= container_store_count())
+    {
+        return false;
+    }
+
+    const container_store_entry_t *entries =
+        (const container_store_entry_t *)(store_base + sizeof(container_store_header_t));
+    memcpy(name, entries[index].name, CONTAINER_NAME_LEN);
+    name[CONTAINER_NAME_LEN] = '\0';
+    return true;
+}
+
+void container_store_close(void)
+{
+    if (!store_base)
+    {
+        return;
+    }
+#ifdef ESP_PLATFORM
+    esp_partition_munmap(store_mmap_handle);
+#else
+    munmap((void *)store_base, store_size);
+#endif
+    store_base = NULL;
+    store_size = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Raw container store: a read-only image of WASM/AOT containers written to a
+// dedicated flash partition (see partitions.csv and
+// containers/pack_containers.py). The whole partition is memory-mapped
+// through the flash MMU, so container bytes are read straight from flash and
+// never copied into DRAM.
+//
+// On Linux the same layout is read from a regular file mapped with mmap().
+
+#define CONTAINER_STORE_LABEL    "containers"
+#define CONTAINER_STORE_SUBTYPE  0x40      // Custom data subtype in partitions.csv
+#define CONTAINER_STORE_MAGIC    0x524E5443 // "CTNR" little endian
+#define CONTAINER_STORE_VERSION  1
+#define CONTAINER_NAME_LEN       32
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;      // CONTAINER_STORE_MAGIC
+    uint16_t version;    // CONTAINER_STORE_VERSION
+    uint16_t count;      // Number of entries following the header
+} container_store_header_t;
+
+typedef struct __attribute__((packed)) {
+    char     name[CONTAINER_NAME_LEN]; // e.g. "controller.aot", NUL padded
+    uint32_t offset;                   // From start of the store, 4-byte aligned
+    uint32_t size;                     // Image size in bytes
+} container_store_entry_t;
+
+// Map the store. On ESP32 `source` is the partition label, on Linux a path to
+// the packed image file. Returns false if no valid store is found.
+bool container_store_open(const char *source);
+
+// Look up an image by file name. The returned pointer stays valid (and
+// read-only) until container_store_close().
+bool container_store_find(const char *name, const uint8_t **data, uint32_t *size);
+
+bool container_store_is_open(void);
+
+// Number of entries, and the NUL-terminated name of entry `index`
+uint16_t container_store_count(void);
+bool container_store_name(uint16_t index, char name[CONTAINER_NAME_LEN + 1]);
+
+void container_store_close(void);
@@ -0,0 +1,904 @@
+#include <stdlib.h>
+#include <string.h>
+#include "control_executor.h"
+#include "cycle_counter.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define TAG "EXECUTOR"
+
+// ============================================================================
+// PERIOD CLOCK
+// ============================================================================
+// ESP32: a periodic esp_timer notifies the executor task, so periods are
+// exact multiples of the hardware timer and independent of FreeRTOS tick
+// granularity (10 ms at CONFIG_FREERTOS_HZ=100).
+// Linux: absolute clock_nanosleep deadlines.
+// Both return the number of periods elapsed since the last wait (> 1 means
+// the previous step overran).
+
+typedef struct {
+#ifdef ESP_PLATFORM
+    esp_timer_handle_t timer;
+#else
+    struct timespec next;
+    uint32_t period_us;
+#endif
+} period_clock_t;
+
+#ifdef ESP_PLATFORM
+static void period_timer_cb(void *arg)
+{
+    xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+static void period_clock_start(period_clock_t *clk, uint32_t period_us)
+{
+    esp_timer_create_args_t args = {
+        .callback = period_timer_cb,
+        .arg = xTaskGetCurrentTaskHandle(),
+        .name = "control_period",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &clk->timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(clk->timer, period_us));
+}
+
+static uint32_t period_clock_wait(period_clock_t *clk)
+{
+    return ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void period_clock_stop(period_clock_t *clk)
+{
+    esp_timer_stop(clk->timer);
+    esp_timer_delete(clk->timer);
+}
+#else
+static void timespec_add_us(struct timespec *ts, uint32_t us)
+{
+    ts->tv_nsec += (long)us * 1000;
+    while (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec++;
+    }
+}
+
+static void period_clock_start(period_clock_t *clk, uint32_t period_us)
+{
+    clk->period_us = period_us;
+    clock_gettime(CLOCK_MONOTONIC, &clk->next);
+    timespec_add_us(&clk->next, period_us);
+}
+
+static bool timespec_before(const struct timespec *a, const struct timespec *b)
+{
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static uint32_t period_clock_wait(period_clock_t *clk)
+{
+    uint32_t periods = 0;
+    struct timespec now;
+
+    // Returns immediately if the deadline already passed
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &clk->next, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // Count every deadline that has passed, like pending timer notifications
+    do
+    {
+        timespec_add_us(&clk->next, clk->period_us);
+        periods++;
+    } while (!timespec_before(&now, &clk->next));
+    return periods;
+}
+
+static void period_clock_stop(period_clock_t *clk)
+{
+    (void)clk;
+}
+#endif
+
+// ============================================================================
+// STEP WATCHDOG
+// ============================================================================
+// One-shot timer armed around each step; on expiry it terminates the step's
+// instance. `armed` decides the race between expiry and disarming: whoever
+// clears it first wins, so a step that returned in time is never terminated
+// afterwards.
+
+typedef struct step_watchdog {
+#ifdef ESP_PLATFORM
+    esp_timer_handle_t timer;
+#else
+    timer_t timer;
+#endif
+    wasm_module_inst_t target; // Instance running the step
+    atomic_bool armed;
+    atomic_bool fired; // Set once the target has been terminated
+} step_watchdog_t;
+
+static void watchdog_expire(step_watchdog_t *wd)
+{
+    if (atomic_exchange(&wd->armed, false))
+    {
+        wasm_runtime_terminate(wd->target);
+        atomic_store(&wd->fired, true);
+    }
+}
+
+#ifdef ESP_PLATFORM
+static void watchdog_timer_cb(void *arg)
+{
+    watchdog_expire(arg);
+}
+#else
+static void watchdog_timer_cb(union sigval value)
+{
+    watchdog_expire(value.sival_ptr);
+}
+#endif
+
+static step_watchdog_t *watchdog_create(const char *name)
+{
+    step_watchdog_t *wd = calloc(1, sizeof(*wd));
+    if (!wd)
+        return NULL;
+
+#ifdef ESP_PLATFORM
+    esp_timer_create_args_t args = {
+        .callback = watchdog_timer_cb,
+        .arg = wd,
+        .name = "step_watchdog",
+    };
+    if (esp_timer_create(&args, &wd->timer) == ESP_OK)
+        return wd;
+#else
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_THREAD;
+    sev.sigev_notify_function = watchdog_timer_cb;
+    sev.sigev_value.sival_ptr = wd;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &wd->timer) == 0)
+        return wd;
+#endif
+    ESP_LOGE(TAG, "%s: cannot create the step watchdog", name);
+    free(wd);
+    return NULL;
+}
+
+static void watchdog_destroy(step_watchdog_t *wd)
+{
+    if (!wd)
+        return;
+#ifdef ESP_PLATFORM
+    esp_timer_stop(wd->timer);
+    esp_timer_delete(wd->timer);
+#else
+    timer_delete(wd->timer);
+#endif
+    free(wd);
+}
+
+static void watchdog_arm(step_watchdog_t *wd, wasm_module_inst_t target, uint32_t timeout_us)
+{
+    wd->target = target;
+    atomic_store(&wd->fired, false);
+    atomic_store(&wd->armed, true);
+#ifdef ESP_PLATFORM
+    esp_timer_start_once(wd->timer, timeout_us);
+#else
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = timeout_us / 1000000;
+    its.it_value.tv_nsec = (long)(timeout_us % 1000000) * 1000;
+    timer_settime(wd->timer, 0, &its, NULL);
+#endif
+}
+
+// Returns true if the watchdog terminated the step
+static bool watchdog_disarm(step_watchdog_t *wd)
+{
+    if (atomic_exchange(&wd->armed, false))
+    {
+#ifdef ESP_PLATFORM
+        esp_timer_stop(wd->timer);
+#else
+        struct itimerspec its;
+        memset(&its, 0, sizeof(its));
+        timer_settime(wd->timer, 0, &its, NULL);
+#endif
+        return false;
+    }
+    // Expired: wait for the callback to finish terminating
+    while (!atomic_load(&wd->fired))
+    {
+#ifdef ESP_PLATFORM
+        vTaskDelay(1); // The timer task may be below us on this core
+#endif
+    }
+    return true;
+}
+
+// ============================================================================
+// SAMPLE TRIGGERS
+// ============================================================================
+// One slot per running on-sample container, keyed by its exec env user data.
+// Slots are static: a notifier never touches freed memory, and a container
+// releasing its slot waits out the notifiers already scanning.
+// ESP32: a task notification to the executor task (its period clock is not
+// running in this mode). Linux: an eventfd, which counts signals in the
+// kernel, so neither side takes a lock.
+
+typedef struct {
+    atomic_bool claimed; // Owned by a container
+    atomic_bool live;    // Notifiers may signal it
+    const void *key;     // Exec env user data
+#ifdef ESP_PLATFORM
+    TaskHandle_t task;
+#else
+    int event_fd;
+#endif
+} sample_trigger_t;
+
+static sample_trigger_t triggers[CONTROL_MAX_TRIGGERED];
+static atomic_uint notifying = 0; // Notifiers scanning the slots
+
+static sample_trigger_t *trigger_claim(const void *key)
+{
+    for (int i = 0; i < CONTROL_MAX_TRIGGERED; i++)
+    {
+        sample_trigger_t *t = &triggers[i];
+        bool expected = false;
+        if (!atomic_compare_exchange_strong(&t->claimed, &expected, true))
+            continue;
+
+        t->key = key;
+#ifdef ESP_PLATFORM
+        t->task = xTaskGetCurrentTaskHandle();
+        ulTaskNotifyTake(pdTRUE, 0); // Drop anything left from the period clock
+#else
+        t->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (t->event_fd < 0)
+        {
+            atomic_store(&t->claimed, false);
+            return NULL;
+        }
+#endif
+        atomic_store(&t->live, true);
+        return t;
+    }
+    return NULL;
+}
+
+static void trigger_release(sample_trigger_t *t)
+{
+    atomic_store(&t->live, false);
+    while (atomic_load(&notifying) > 0)
+    {
+#ifdef ESP_PLATFORM
+        vTaskDelay(1);
+#endif
+    }
+#ifndef ESP_PLATFORM
+    close(t->event_fd);
+#endif
+    atomic_store(&t->claimed, false);
+}
+
+static void trigger_signal(sample_trigger_t *t)
+{
+#ifdef ESP_PLATFORM
+    xTaskNotifyGive(t->task);
+#else
+    uint64_t one = 1;
+    (void)!write(t->event_fd, &one, sizeof(one)); // Non-blocking; fails only at 2^64 - 1
+#endif
+}
+
+// Wait for a sample, at most timeout_us. Returns false on timeout.
+static bool trigger_wait(sample_trigger_t *t, uint32_t timeout_us)
+{
+#ifdef ESP_PLATFORM
+    TickType_t ticks = pdMS_TO_TICKS(timeout_us / 1000);
+    return ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1) > 0;
+#else
+    int64_t deadline = esp_timer_get_time() + timeout_us;
+    struct pollfd pfd = {.fd = t->event_fd, .events = POLLIN};
+    int64_t left;
+    while ((left = deadline - esp_timer_get_time()) > 0 &&
+           poll(&pfd, 1, (int)((left + 999) / 1000)) < 0 && errno == EINTR)
+    {
+    }
+
+    // Reading resets the count: samples that arrived meanwhile coalesce
+    uint64_t count;
+    return read(t->event_fd, &count, sizeof(count)) == sizeof(count);
+#endif
+}
+
+void control_executor_notify(const void *user_data)
+{
+    atomic_fetch_add(&notifying, 1);
+    for (int i = 0; i < CONTROL_MAX_TRIGGERED; i++)
+    {
+        sample_trigger_t *t = &triggers[i];
+        if (atomic_load(&t->live) && t->key == user_data)
+        {
+            trigger_signal(t);
+        }
+    }
+    atomic_fetch_sub(&notifying, 1);
+}
+
+// ============================================================================
+// I/O WINDOW
+// ============================================================================
+
+static const control_io_ops_t *io_ops = NULL;
+
+// Container address of the caller's I/O window, 0 if it has none (legacy
+// containers, or the window could not be allocated)
+static uint32_t host_io_window(wasm_exec_env_t exec_env)
+{
+    control_container_t *c = wasm_runtime_get_custom_data(wasm_runtime_get_module_inst(exec_env));
+    return c ? c->io_app : 0;
+}
+
+static NativeSymbol io_symbols[] = {
+    {"host_io_window", host_io_window, "()i", NULL},
+};
+
+bool control_executor_init_io(const control_io_ops_t *ops)
+{
+    io_ops = ops;
+    return wasm_runtime_register_natives("env", io_symbols,
+                                         sizeof(io_symbols) / sizeof(NativeSymbol));
+}
+
+// ============================================================================
+// CONTAINER STEPPING
+// ============================================================================
+
+static void set_deadline(control_container_t *c, uint32_t deadline_us)
+{
+    uint64_t cycles = (uint64_t)deadline_us * cycle_counter_per_us();
+    c->deadline_us = deadline_us;
+    c->deadline_cycles = cycles > UINT32_MAX ? UINT32_MAX : (uint32_t)cycles;
+}
+
+bool control_module_has_step(wasm_module_t module)
+{
+    int32_t count = wasm_runtime_get_export_count(module);
+    for (int32_t i = 0; i < count; i++)
+    {
+        wasm_export_t export_type;
+        wasm_runtime_get_export_type(module, i, &export_type);
+        if (export_type.kind == WASM_IMPORT_EXPORT_KIND_FUNC
+            && strcmp(export_type.name, "step") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+control_bind_result_t control_container_bind(control_container_t *c, const char *name,
+                                             wasm_module_inst_t module_inst,
+                                             wasm_exec_env_t exec_env, uint32_t period_us)
+{
+    memset(c, 0, sizeof(*c));
+    c->name = name;
+    c->module_inst = module_inst;
+    c->exec_env = exec_env;
+    c->period_us = period_us;
+
+    c->step_func = wasm_runtime_lookup_function(module_inst, "step");
+    if (!c->step_func)
+    {
+        return CONTROL_BIND_NO_STEP;
+    }
+
+    // Allocated from the instance's app heap, so it goes with the instance
+    c->io_app = (uint32_t)wasm_runtime_module_malloc(module_inst, sizeof(container_io_t),
+                                                     (void **)&c->io);
+    if (c->io)
+    {
+        memset(c->io, 0, sizeof(container_io_t));
+    }
+    else
+    {
+        c->io_app = 0;
+        ESP_LOGW(TAG, "%s: no room for the I/O window", name);
+    }
+    wasm_runtime_set_custom_data(module_inst, c); // For host_io_window
+
+    wasm_function_inst_t init_func = wasm_runtime_lookup_function(module_inst, "init");
+    if (init_func && !wasm_runtime_call_wasm(exec_env, init_func, 0, NULL))
+    {
+        const char *exception = wasm_runtime_get_exception(module_inst);
+        ESP_LOGE(TAG, "%s: init failed: %s", name, exception ? exception : "unknown");
+        return CONTROL_BIND_INIT_FAILED;
+    }
+
+    // Not limited until set_budget, but misses are counted against the period
+    set_deadline(c, period_us);
+    return CONTROL_BIND_OK;
+}
+
+bool control_container_set_budget(control_container_t *c, const container_budget_t *budget)
+{
+    container_budget_t defaults;
+    if (!budget)
+    {
+        container_budget_default(&defaults);
+        budget = &defaults;
+    }
+
+    set_deadline(c, budget->step_deadline_us ? budget->step_deadline_us : c->period_us);
+    c->on_sample = budget->step_on_sample != 0;
+    if (!c->watchdog)
+    {
+        c->watchdog = watchdog_create(c->name);
+    }
+
+#if WASM_ENABLE_INSTRUCTION_METERING != 0
+    // Counted per call: every step starts with the full allowance
+    wasm_runtime_set_instruction_count_limit(
+        c->exec_env, budget->step_instructions ? (int)budget->step_instructions : -1);
+#else
+    if (budget->step_instructions)
+    {
+        ESP_LOGW(TAG, "%s: runtime built without instruction metering, step_instructions ignored",
+                 c->name);
+    }
+#endif
+    return c->watchdog != NULL;
+}
+
+void control_container_unbind(control_container_t *c)
+{
+    watchdog_destroy(c->watchdog);
+    c->watchdog = NULL;
+}
+
+control_container_t *control_container_prepare(wasm_module_t module, const char *name,
+                                               const container_budget_t *budget,
+                                               uint32_t period_us, void *user_data)
+{
+    char error_buf[128];
+    container_budget_t defaults;
+
+    if (!budget)
+    {
+        container_budget_default(&defaults);
+        budget = &defaults;
+    }
+
+    wasm_module_inst_t module_inst = container_budget_instantiate(module, budget, error_buf,
+                                                                  sizeof(error_buf));
+    if (!module_inst)
+    {
+        ESP_LOGE(TAG, "%s: instantiation failed: %s", name, error_buf);
+        return NULL;
+    }
+
+    wasm_exec_env_t exec_env = container_budget_exec_env(module_inst, budget);
+    control_container_t *c = malloc(sizeof(*c));
+    if (!exec_env || !c)
+    {
+        ESP_LOGE(TAG, "%s: out of memory", name);
+        goto fail;
+    }
+    wasm_runtime_set_user_data(exec_env, user_data);
+
+    if (control_container_bind(c, name, module_inst, exec_env, period_us) != CONTROL_BIND_OK)
+    {
+        goto fail;
+    }
+    if (!control_container_set_budget(c, budget))
+    {
+        control_container_unbind(c);
+        goto fail;
+    }
+    return c;
+
+fail:
+    free(c);
+    if (exec_env)
+        wasm_runtime_destroy_exec_env(exec_env);
+    wasm_runtime_deinstantiate(module_inst);
+    return NULL;
+}
+
+void control_container_destroy(control_container_t *c)
+{
+    control_container_t *next = atomic_exchange(&c->pending, NULL);
+    if (next)
+    {
+        control_container_destroy(next);
+    }
+    control_container_unbind(c);
+    wasm_runtime_destroy_exec_env(c->exec_env);
+    wasm_runtime_deinstantiate(c->module_inst);
+    free(c);
+}
+
+bool control_executor_swap(control_container_t *c, control_container_t *next)
+{
+    control_container_t *expected = NULL;
+    next->offered_us = esp_timer_get_time();
+    return atomic_compare_exchange_strong_explicit(&c->pending, &expected, next,
+                                                   memory_order_release, memory_order_relaxed);
+}
+
+// Take over an offered replacement, if any. Called right after a step, so
+// the swap always lands on a period boundary and never delays a step.
+static void adopt_pending(control_container_t *c)
+{
+    control_container_t *next = atomic_exchange_explicit(&c->pending, NULL, memory_order_acquire);
+    if (!next)
+    {
+        return;
+    }
+
+    control_container_report(c); // Final statistics of the outgoing law
+    int64_t adopted = esp_timer_get_time();
+    wasm_module_inst_t old_inst = c->module_inst;
+    wasm_exec_env_t old_env = c->exec_env;
+
+    c->name = next->name;
+    c->module_inst = next->module_inst;
+    c->exec_env = next->exec_env;
+    c->step_func = next->step_func;
+    c->io = next->io;
+    c->io_app = next->io_app;
+    wasm_runtime_set_custom_data(c->module_inst, c);
+    c->last_swap_wait_us = (uint32_t)(adopted - next->offered_us);
+
+    // The new law's budgets, watchdog and trigger included; run() switches
+    // between periodic and on-sample stepping when the trigger changes
+    step_watchdog_t *old_watchdog = c->watchdog;
+    c->deadline_us = next->deadline_us;
+    c->deadline_cycles = next->deadline_cycles;
+    c->watchdog = next->watchdog;
+    c->on_sample = next->on_sample;
+    free(next);
+
+    // Fresh statistics for the new law
+    c->steps = 0;
+    c->overruns = 0;
+    c->deadline_misses = 0;
+    c->budget_aborts = 0;
+    c->aborts_in_row = 0;
+    c->last_step_cycles = 0;
+    c->wcet_cycles = 0;
+    c->total_step_cycles = 0;
+
+    watchdog_destroy(old_watchdog);
+    wasm_runtime_destroy_exec_env(old_env);
+    wasm_runtime_deinstantiate(old_inst);
+    c->last_swap_retire_us = (uint32_t)(esp_timer_get_time() - adopted);
+
+    atomic_fetch_add_explicit(&c->swaps, 1, memory_order_release);
+    ESP_LOGI(TAG, "%s: swapped in at period boundary | waited %lu us | retired old in %lu us",
+             c->name, (unsigned long)c->last_swap_wait_us, (unsigned long)c->last_swap_retire_us);
+}
+
+// Step time bookkeeping, in cycles
+static void record_step(control_container_t *c, uint32_t cycles)
+{
+    c->recent_cycles[c->steps % CONTROL_STEP_WINDOW] = cycles;
+    c->steps++;
+    c->last_step_cycles = cycles;
+    c->total_step_cycles += cycles;
+    if (cycles > c->wcet_cycles)
+        c->wcet_cycles = cycles;
+    if (cycles > c->deadline_cycles)
+        c->deadline_misses++;
+}
+
+bool control_container_step(control_container_t *c, float dt)
+{
+    uint32_t argv[1];
+    memcpy(&argv[0], &dt, sizeof(float)); // f32 argument cell
+
+    // Window exchange is part of the step cost
+    uint32_t start = cycle_count();
+    void *user_data = wasm_runtime_get_user_data(c->exec_env);
+    if (c->io && io_ops)
+    {
+        io_ops->fill(user_data, c->io);
+        c->io->actuator_dirty = 0;
+    }
+    if (c->watchdog)
+    {
+        watchdog_arm(c->watchdog, c->module_inst, c->deadline_us);
+    }
+    bool ok = wasm_runtime_call_wasm(c->exec_env, c->step_func, 1, argv);
+    bool terminated = c->watchdog && watchdog_disarm(c->watchdog);
+    if (ok && !terminated && c->io && io_ops && c->io->actuator_dirty)
+    {
+        io_ops->drain(user_data, c->io);
+    }
+    record_step(c, cycle_count() - start);
+
+    const char *exception = ok ? NULL : wasm_runtime_get_exception(c->module_inst);
+    bool over_budget = terminated || (exception && strstr(exception, "instruction limit"));
+    if (!over_budget)
+    {
+        c->aborts_in_row = 0;
+        if (!ok)
+        {
+            ESP_LOGE(TAG, "%s: step trapped: %s", c->name, exception ? exception : "unknown");
+        }
+        return ok;
+    }
+
+    // Cut short: drop the step, keep the container
+    c->budget_aborts++;
+    if (c->aborts_in_row++ == 0)
+    {
+        ESP_LOGW(TAG, "%s: step %lu over budget (%s), cut short", c->name,
+                 (unsigned long)c->steps, terminated ? "deadline" : "instructions");
+    }
+    wasm_runtime_clear_exception(c->module_inst);
+    if (c->aborts_in_row < CONTROL_MAX_ABORTS)
+    {
+        return true;
+    }
+    ESP_LOGE(TAG, "%s: %d steps in a row over budget, stopping", c->name, CONTROL_MAX_ABORTS);
+    return false;
+}
+
+static void record_wake(control_container_t *c, uint32_t periods)
+{
+    int64_t now = esp_timer_get_time();
+    if (c->last_wake_us)
+    {
+        int64_t off = (now - c->last_wake_us) - (int64_t)periods * c->period_us;
+        uint32_t jitter = (uint32_t)(off < 0 ? -off : off);
+        c->wakes++;
+        c->total_jitter_us += jitter;
+        if (jitter > c->max_jitter_us)
+            c->max_jitter_us = jitter;
+    }
+    c->last_wake_us = now;
+}
+
+// Step on every sample, with the period as a timeout. Returns true when a
+// swapped-in law steps periodically instead, false once the container stops.
+static bool run_on_sample(control_container_t *c, sample_trigger_t *trigger)
+{
+    int64_t last = esp_timer_get_time();
+    int64_t next_report = last + CONTROL_REPORT_PERIOD_MS * 1000LL;
+
+    ESP_LOGI(TAG, "%s: stepping on samples, at least every %lu us", c->name,
+             (unsigned long)c->period_us);
+    while (1)
+    {
+        if (!trigger_wait(trigger, c->period_us))
+        {
+            c->sample_timeouts++;
+        }
+
+        int64_t now = esp_timer_get_time();
+        float dt = (now - last) / 1e6f;
+        last = now;
+        if (!control_container_step(c, dt))
+        {
+            return false;
+        }
+
+        if (now >= next_report)
+        {
+            control_container_report(c);
+            next_report += CONTROL_REPORT_PERIOD_MS * 1000LL;
+        }
+        adopt_pending(c);
+        if (!c->on_sample)
+        {
+            return true;
+        }
+    }
+}
+
+// Step every period. Returns true when a swapped-in law steps on samples
+// instead, false once the container stops.
+static bool run_periodic(control_container_t *c)
+{
+    period_clock_t clk;
+    const float period_s = c->period_us / 1e6f;
+    const uint32_t report_every = CONTROL_REPORT_PERIOD_MS * 1000 / c->period_us;
+    bool switched = false;
+
+    ESP_LOGI(TAG, "%s: stepping every %lu us", c->name, (unsigned long)c->period_us);
+    c->last_wake_us = 0; // No jitter across a switch from on-sample stepping
+    period_clock_start(&clk, c->period_us);
+
+    while (!switched)
+    {
+        uint32_t periods = period_clock_wait(&clk);
+        record_wake(c, periods);
+        if (periods > 1)
+        {
+            c->overruns += periods - 1;
+        }
+
+        if (!control_container_step(c, periods * period_s))
+        {
+            break;
+        }
+
+        if (report_every && c->steps % report_every == 0)
+        {
+            control_container_report(c);
+        }
+        adopt_pending(c);
+        switched = c->on_sample;
+    }
+
+    period_clock_stop(&clk);
+    return switched;
+}
+
+void control_executor_run(control_container_t *c)
+{
+    bool running = true;
+    while (running)
+    {
+        if (c->on_sample)
+        {
+            sample_trigger_t *trigger = trigger_claim(wasm_runtime_get_user_data(c->exec_env));
+            if (trigger)
+            {
+                running = run_on_sample(c, trigger);
+                trigger_release(trigger);
+                continue;
+            }
+            ESP_LOGW(TAG, "%s: %d on-sample containers already running, stepping periodically",
+                     c->name, CONTROL_MAX_TRIGGERED);
+            c->on_sample = false;
+        }
+        running = run_periodic(c);
+    }
+}
+
+void control_executor_run_module(wasm_module_t module, const char *name,
+                                 const container_budget_t *budget, uint32_t period_us,
+                                 void *user_data)
+{
+    char error_buf[128];
+    container_budget_t defaults;
+
+    if (!budget)
+    {
+        container_budget_default(&defaults);
+        budget = &defaults;
+    }
+
+    // Linear memory is separate and defined in the WASM module itself
+    wasm_module_inst_t module_inst = container_budget_instantiate(module, budget, error_buf,
+                                                                  sizeof(error_buf));
+    if (!module_inst)
+    {
+        ESP_LOGE(TAG, "%s: instantiation failed: %s", name, error_buf);
+        return;
+    }
+
+    wasm_exec_env_t exec_env = container_budget_exec_env(module_inst, budget);
+    if (!exec_env)
+    {
+        ESP_LOGE(TAG, "%s: exec env creation failed", name);
+        wasm_runtime_deinstantiate(module_inst);
+        return;
+    }
+    wasm_runtime_set_user_data(exec_env, user_data);
+
+    // Step-ABI container: the host schedules step() at a fixed rate
+    control_container_t container;
+    control_bind_result_t bound = control_container_bind(&container, name, module_inst, exec_env,
+                                                         period_us);
+    if (bound == CONTROL_BIND_OK)
+    {
+        if (control_container_set_budget(&container, budget))
+        {
+            control_executor_run(&container);
+            control_container_report(&container);
+        }
+        control_container_unbind(&container);
+    }
+    else if (bound == CONTROL_BIND_NO_STEP)
+    {
+        // Legacy container: main() loops forever and paces itself with host_delay
+        wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, "main");
+        if (func)
+        {
+            uint32_t args[2] = {0, 0}; // argc, argv
+            if (!wasm_runtime_call_wasm(exec_env, func, 2, args))
+            {
+                const char *exception = wasm_runtime_get_exception(module_inst);
+                if (exception && strstr(exception, "terminated"))
+                {
+                    ESP_LOGW(TAG, "%s: execution terminated", name);
+                }
+                else
+                {
+                    ESP_LOGE(TAG, "%s: exception: %s", name, exception ? exception : "unknown");
+                }
+            }
+            else
+            {
+                ESP_LOGI(TAG, "%s: execution completed successfully", name);
+            }
+        }
+        else
+        {
+            ESP_LOGE(TAG, "%s: no step or main function found", name);
+        }
+    }
+
+    wasm_runtime_destroy_exec_env(exec_env);
+    wasm_runtime_deinstantiate(module_inst);
+}
+
+static int compare_cycles(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+void control_container_stats(const control_container_t *c, control_step_stats_t *stats)
+{
+    uint32_t sorted[CONTROL_STEP_WINDOW];
+    uint32_t n = c->steps < CONTROL_STEP_WINDOW ? c->steps : CONTROL_STEP_WINDOW;
+
+    memcpy(sorted, c->recent_cycles, n * sizeof(uint32_t));
+    qsort(sorted, n, sizeof(uint32_t), compare_cycles);
+
+    stats->mean_cycles = c->steps ? (uint32_t)(c->total_step_cycles / c->steps) : 0;
+    stats->p99_cycles = n ? sorted[(n * 99 + 99) / 100 - 1] : 0; // Nearest rank
+    stats->wcet_cycles = c->wcet_cycles;
+
+    float per_us = (float)cycle_counter_per_us();
+    stats->mean_us = stats->mean_cycles / per_us;
+    stats->p99_us = stats->p99_cycles / per_us;
+    stats->wcet_us = stats->wcet_cycles / per_us;
+}
+
+void control_container_report(const control_container_t *c)
+{
+    control_step_stats_t stats;
+    control_container_stats(c, &stats);
+    ESP_LOGI(TAG, "%s: %lu steps | step mean %.1f us p99 %.1f us wcet %.1f us (%lu cycles) | "
+                  "deadline %lu us: %lu missed, %lu cut short | overruns %lu",
+             c->name, (unsigned long)c->steps, stats.mean_us, stats.p99_us, stats.wcet_us,
+             (unsigned long)stats.wcet_cycles, (unsigned long)c->deadline_us,
+             (unsigned long)c->deadline_misses, (unsigned long)c->budget_aborts,
+             (unsigned long)c->overruns);
+    if (c->on_sample)
+    {
+        ESP_LOGI(TAG, "%s: stepped on samples, %lu steps with none within a period", c->name,
+                 (unsigned long)c->sample_timeouts);
+    }
+    if (c->wakes) // Only run() schedules wake-ups
+    {
+        ESP_LOGI(TAG, "%s: wake jitter mean %lu us max %lu us over %lu periods", c->name,
+                 (unsigned long)(c->total_jitter_us / c->wakes), (unsigned long)c->max_jitter_us,
+                 (unsigned long)c->wakes);
+    }
+}
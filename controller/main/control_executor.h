@@ -0,0 +1,178 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "container_budget.h"
+#include "container_io.h"
+#include "wasm_export.h"
+
+// Host-side scheduler for step-ABI containers (see containers/container_abi.h).
+// The host owns the timing: step(dt) is called at a fixed rate from a
+// drift-free periodic timer, and each call is timed with the CPU cycle
+// counter (cycle_counter.h).
+//
+// A container whose manifest sets step_on_sample is stepped on sensor
+// arrival instead: the acquisition stage calls control_executor_notify()
+// for every new sample, and the container steps right away with dt the
+// time since its previous step. Samples arriving during a step coalesce
+// into one more step. If none arrives for a period, it steps anyway, so
+// a silent sensor still gets the law's fallback behaviour.
+//
+// Every step runs within the container's step budgets (container_budget.h):
+//   - an instruction limit, when the runtime is built with instruction
+//     metering (interpreter only; AOT code is not metered)
+//   - a deadline, one period unless the manifest sets one: a watchdog calls
+//     wasm_runtime_terminate() on a step still running then. Interpreted
+//     code stops at its next branch when the runtime has thread support
+//     (WAMR pthreads, as on the firmware), AOT code only if wamrc compiled
+//     it with --enable-multi-thread; otherwise the step counts as aborted
+//     once it returns.
+// A step over budget is cut short: its actuator writes are dropped, so the
+// actuators hold their last values, and the container carries on with the
+// next period. Steps longer than the deadline are counted as misses whether
+// or not the watchdog could stop them.
+
+#define CONTROL_REPORT_PERIOD_MS 10000 // How often run() logs step statistics
+#define CONTROL_STEP_WINDOW      128   // Latest step times kept for the p99
+#define CONTROL_MAX_ABORTS       3     // Over-budget steps in a row before a container is stopped
+#define CONTROL_MAX_TRIGGERED    8     // Event-driven containers running at once
+
+struct step_watchdog;
+
+typedef struct control_container {
+    const char *name;
+    wasm_module_inst_t module_inst;
+    wasm_exec_env_t exec_env;
+    wasm_function_inst_t step_func; // Looked up once at bind time
+    uint32_t period_us;
+    bool on_sample;                 // Stepped by control_executor_notify()
+
+    // Shared I/O window in the container's linear memory (container_io.h)
+    container_io_t *io;             // Native address, NULL if allocation failed
+    uint32_t io_app;                // Same window as a container address
+
+    // Step budgets (control_container_set_budget)
+    uint32_t deadline_us;
+    uint32_t deadline_cycles;
+    struct step_watchdog *watchdog; // Terminates a step still running at the deadline
+
+    // Step statistics, in CPU cycles (cycle_counter.h)
+    uint32_t steps;
+    uint32_t overruns;              // Periods skipped because a step ran late
+    uint32_t deadline_misses;       // Steps that took longer than the deadline
+    uint32_t budget_aborts;         // Steps cut short by a step budget
+    uint32_t aborts_in_row;
+    uint32_t last_step_cycles;
+    uint32_t wcet_cycles;           // Longest step so far
+    uint64_t total_step_cycles;
+    uint32_t recent_cycles[CONTROL_STEP_WINDOW]; // Ring of the latest step times
+
+    // Release jitter of run(): how far each wake-up is from its period
+    // boundary, kept across swaps (it belongs to the schedule, not the law)
+    int64_t last_wake_us;
+    uint32_t wakes;
+    uint32_t max_jitter_us;
+    uint64_t total_jitter_us;
+    uint32_t sample_timeouts;       // On-sample steps run with no new sample
+
+    // Live replacement (see control_executor_swap)
+    _Atomic(struct control_container *) pending; // Offered, not yet adopted
+    _Atomic uint32_t swaps;                      // Replacements adopted so far
+    uint32_t last_swap_wait_us;   // Offer -> adoption at a period boundary
+    uint32_t last_swap_retire_us; // Tearing down the replaced instance
+    int64_t offered_us;           // Set on the replacement when offered
+} control_container_t;
+
+// Step time summary of a container, for sizing control periods
+typedef struct {
+    uint32_t mean_cycles;
+    uint32_t p99_cycles;  // Over the latest CONTROL_STEP_WINDOW steps
+    uint32_t wcet_cycles; // Longest step so far
+    float mean_us;
+    float p99_us;
+    float wcet_us;
+} control_step_stats_t;
+
+// Moves channel values between the natives' state and the I/O window.
+// `user_data` is the exec env user data (e.g. a controller_link binding).
+typedef struct {
+    void (*fill)(void *user_data, container_io_t *io);        // Before step()
+    void (*drain)(void *user_data, const container_io_t *io); // After step(),
+                                                              // if any actuator was written
+} control_io_ops_t;
+
+// Enable the shared I/O window: registers the host_io_window native, which
+// hands a container its window, and the hooks run around every step. Call
+// once, after wasm_runtime_full_init(). `ops` must stay valid.
+bool control_executor_init_io(const control_io_ops_t *ops);
+
+typedef enum {
+    CONTROL_BIND_OK,
+    CONTROL_BIND_NO_STEP,     // Not a step-ABI module (may be a legacy main() loop)
+    CONTROL_BIND_INIT_FAILED, // Has step(), but init() trapped (logged)
+} control_bind_result_t;
+
+// True if `module` exports step(), i.e. implements the step ABI
+bool control_module_has_step(wasm_module_t module);
+
+// Look up init/step, allocate the I/O window and run init()
+control_bind_result_t control_container_bind(control_container_t *c, const char *name,
+                                             wasm_module_inst_t module_inst,
+                                             wasm_exec_env_t exec_env, uint32_t period_us);
+
+// Apply the step budgets of `budget` (NULL: the defaults) to a bound
+// container. Until then its steps are timed but not limited.
+bool control_container_set_budget(control_container_t *c, const container_budget_t *budget);
+
+// Free what set_budget allocated. The instance and exec env stay with the
+// caller (control_container_destroy does both).
+void control_container_unbind(control_container_t *c);
+
+// Instantiate `module` within `budget` (NULL: the defaults, see
+// container_budget.h), attach `user_data` for the natives and bind it (runs
+// init()) into a heap-allocated container. Returns NULL, with nothing left
+// allocated, if the module does not implement the step ABI or could not be
+// set up. Use this off the control path to prepare a hot swap.
+control_container_t *control_container_prepare(wasm_module_t module, const char *name,
+                                               const container_budget_t *budget,
+                                               uint32_t period_us, void *user_data);
+
+// Deinstantiate and free a container made by control_container_prepare()
+void control_container_destroy(control_container_t *c);
+
+// Hot swap: offer `next` (from control_container_prepare) to the executor
+// running `c`. Right after its next step the executor adopts it in place of
+// the current instance, so the new law's first step lands exactly one period
+// after the old law's last one, then tears down the old instance and frees
+// `next`. Returns false if another swap is still pending.
+bool control_executor_swap(control_container_t *c, control_container_t *next);
+
+// Run one timed step. Returns false if the container trapped, or went over
+// its step budget CONTROL_MAX_ABORTS times in a row; a single over-budget
+// step is cut short, counted and returns true.
+bool control_container_step(control_container_t *c, float dt);
+
+// Call step() every period, or on every sample for on-sample containers,
+// until the container traps. Does not return otherwise. The triggering mode
+// is the one set_budget picked, and follows the law swapped in.
+void control_executor_run(control_container_t *c);
+
+// A new sensor sample for the containers whose exec env user data is
+// `user_data` (NULL: containers without one): wake those running on
+// samples. Lock-free and never blocks: a task notification on the ESP32, a
+// non-blocking eventfd write on Linux. Call from the acquisition task or
+// receive callback that published the sample, not from an ISR.
+void control_executor_notify(const void *user_data);
+
+void control_container_stats(const control_container_t *c, control_step_stats_t *stats);
+
+void control_container_report(const control_container_t *c);
+
+// Instantiate `module` within `budget` (NULL: the defaults) and run it until
+// it stops: step-ABI containers via control_executor_run() every period_us,
+// legacy containers by calling main(), which paces itself with host_delay().
+// `user_data` is attached to the exec env for the natives
+// (wasm_runtime_get_user_data), may be NULL. The module is not unloaded.
+void control_executor_run_module(wasm_module_t module, const char *name,
+                                 const container_budget_t *budget, uint32_t period_us,
+                                 void *user_data);
@@ -1,253 +1,50 @@
 #include <stdio.h>
 #include <string.h>
-#include <dirent.h>
 #include <pthread.h>
-#include "esp_mac.h"
-#include "esp_now.h"
-#include "esp_wifi.h"
-#include "nvs_flash.h"
 #include "esp_log.h"
 #include "esp_spiffs.h"
-#include "simulation_data_packet.h"
+#include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
-#include "esp_timer.h"
 #include "wasm_export.h"
+#include "container_manager.h"
+#include "container_store.h"
+#include "control_executor.h"
+#include "controller_link.h"
+#include "filter_natives.h"
+#include "sim_transport.h"
+#include "latency_hist.h"
+#include "sim_pipeline.h"
+#include "sim_trace.h"
 
 #define TAG "CONTROLLER"
-#define GLOBAL_HEAP_SIZE (50 * 1024)
 
-uint8_t bridge_mac[] = {0x08, 0x3a, 0xf2, 0x45, 0xae, 0xac};
-
-// --- STATE VARIABLES (shared with WASM) ---
-static float current_temp = 25.0f; // Current temperature from bridge
-static float heater_cmd = 0.0f;    // 0.0 = OFF, 1.0 = ON
-static SemaphoreHandle_t temp_mutex = NULL;
-
-// ============================================================================
-// NATIVE FUNCTIONS (Exposed to WASM)
-// ============================================================================
-
-// Get current temperature reading from the bridge
-float host_get_temperature(wasm_exec_env_t exec_env)
-{
-    float temp = 25.0f;
-    if (xSemaphoreTake(temp_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
-    {
-        temp = current_temp;
-        xSemaphoreGive(temp_mutex);
-    }
-    return temp;
-}
-
-// Set heater command (0.0 = OFF, 1.0 = ON)
-void host_set_heater(wasm_exec_env_t exec_env, float value)
-{
-    // Clamp value to 0-1 range
-    if (value < 0.0f)
-        value = 0.0f;
-    if (value > 1.0f)
-        value = 1.0f;
-
-    if (xSemaphoreTake(temp_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
-    {
-        heater_cmd = value;
-        xSemaphoreGive(temp_mutex);
-    }
-    ESP_LOGI(TAG, "WASM set heater to %.0f%%", value * 100.0f);
-}
-
-// Delay function for WASM
-void host_delay(wasm_exec_env_t exec_env, int ms)
-{
-    vTaskDelay(pdMS_TO_TICKS(ms));
-}
-
-// Log function for WASM (prints to ESP32 console)
-void host_log(wasm_exec_env_t exec_env, const char *message)
-{
-    if (message)
-    {
-        ESP_LOGI("WASM", "%s", message);
-    }
-}
+#define CONTROL_PERIOD_MS 100 // step() period for step-ABI containers
+#define UPDATE_POLL_MS   1000 // Check SPIFFS for replaced container images
+#define TRACE_DRAIN_MS   1000 // Telemetry trace drain period (sim_trace.h)
 
-// Native symbol registration
-static NativeSymbol native_symbols[] = {
-    {"host_get_temperature", host_get_temperature, "()f", NULL},
-    {"host_set_heater", host_set_heater, "(f)", NULL},
-    {"host_delay", host_delay, "(i)", NULL},
-    {"host_log", host_log, "($)", NULL},
-};
+#define PIN_DUMP_BUTTON 0 // BOOT button: hold to dump the latency histograms
 
-// ============================================================================
-// SPIFFS & WASM LOADER
-// ============================================================================
-
-void run_wasm(uint8_t *buffer, uint32_t size)
-{
-    char error_buf[128];
-    wasm_module_t module = NULL;
-    wasm_module_inst_t module_inst = NULL;
-    wasm_exec_env_t exec_env = NULL;
-
-    // Load module
-    module = wasm_runtime_load(buffer, size, error_buf, sizeof(error_buf));
-    if (!module)
-    {
-        ESP_LOGE(TAG, "WASM load failed: %s", error_buf);
-        return;
-    }
-
-    // Instantiate module
-    module_inst = wasm_runtime_instantiate(module, 8 * 1024, 8 * 1024, error_buf, sizeof(error_buf));
-    if (!module_inst)
-    {
-        ESP_LOGE(TAG, "WASM instantiation failed: %s", error_buf);
-        wasm_runtime_unload(module);
-        return;
-    }
-
-    // Create execution environment
-    exec_env = wasm_runtime_create_exec_env(module_inst, 8 * 1024);
-    if (!exec_env)
-    {
-        ESP_LOGE(TAG, "Exec env creation failed");
-        wasm_runtime_deinstantiate(module_inst);
-        wasm_runtime_unload(module);
-        return;
-    }
-
-    // Store global instance
-    global_module_inst = module_inst;
-
-    ESP_LOGI(TAG, "Starting WASM Control Module...");
-
-    // Look for main function
-    wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, "main");
-
-    if (func)
-    {
-        uint32_t args[2] = {0, 0}; // argc, argv
-        if (!wasm_runtime_call_wasm(exec_env, func, 2, args))
-        {
-            const char *exception = wasm_runtime_get_exception(module_inst);
-            if (exception && strstr(exception, "terminated"))
-            {
-                ESP_LOGW(TAG, "WASM execution terminated");
-            }
-            else
-            {
-                ESP_LOGE(TAG, "WASM exception: %s", exception ? exception : "unknown");
-            }
-        }
-        else
-        {
-            ESP_LOGI(TAG, "WASM execution completed successfully");
-        }
-    }
-    else
-    {
-        ESP_LOGE(TAG, "No main function found in WASM module");
-    }
-
-    // Cleanup
-    global_module_inst = NULL;
-    wasm_runtime_destroy_exec_env(exec_env);
-    wasm_runtime_deinstantiate(module_inst);
-    wasm_runtime_unload(module);
-}
-
-// ============================================================================
-// ESP-NOW COMMUNICATION
-// ============================================================================
-
-static void esp_now_wifi_init(void)
-{
-    esp_err_t ret = nvs_flash_init();
-    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
-    {
-        nvs_flash_erase();
-        nvs_flash_init();
-    }
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_start());
-    if (esp_now_init() != ESP_OK)
-    {
-        ESP_LOGE(TAG, "ESP-NOW Init Failed");
-        return;
-    }
-}
-
-static void add_peer(uint8_t mac_addr[6])
-{
-    esp_now_peer_info_t peerInfo = {};
-    memcpy(peerInfo.peer_addr, mac_addr, 6);
-    peerInfo.channel = 0;
-    peerInfo.encrypt = false;
-
-    if (esp_now_add_peer(&peerInfo) != ESP_OK)
-    {
-        ESP_LOGE(TAG, "Failed to add peer");
-        return;
-    }
-}
-
-// ESP-NOW receive callback - updates current temperature
-void onReceiveData(const esp_now_recv_info_t *esp_now_info, const uint8_t *data, int len)
-{
-    if (len == sizeof(SimPacket))
-    {
-        SimPacket *p = (SimPacket *)data;
-
-        // Check if this is a temperature sensor reading from the bridge (device_id=0, id=1)
-        if (p->device_id == 0 && p->id == 1)
-        {
-            // Update current temperature (thread-safe)
-            if (xSemaphoreTake(temp_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
-            {
-                current_temp = p->value;
-                xSemaphoreGive(temp_mutex);
-            }
-        }
-    }
-}
+uint8_t bridge_mac[] = {0x08, 0x3a, 0xf2, 0x45, 0xae, 0xac};
 
 // ============================================================================
 // SENDER TASK - Continuously sends heater commands to bridge
 // ============================================================================
 
+// Comms stage, on the radio's core (sim_pipeline.h): every command goes out
+// as soon as a container makes it, plus a keep-alive frame when idle
 void sender_task(void *arg)
 {
-    int32_t packet_counter = 0;
-    const int SEND_INTERVAL_MS = 100; // 10Hz
-
     while (1)
     {
-        float cmd_to_send;
-        if (xSemaphoreTake(temp_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+        controller_link_wait_commands(CONTROLLER_LINK_SEND_MS * 1000);
+        controller_link_send_actuators();
+        if (gpio_get_level(PIN_DUMP_BUTTON) == 0)
         {
-            cmd_to_send = heater_cmd;
-            xSemaphoreGive(temp_mutex);
+            latency_hist_dump_all();
+            ESP_LOGI(TAG, "Heater commands dropped: %lu",
+                     (unsigned long)controller_link_dropped_commands());
         }
-        else
-        {
-            cmd_to_send = 0.0f;
-        }
-
-        SimPacket packet = {
-            .device_id = 1,
-            .id = 1,
-            .value = cmd_to_send,
-            .counter = packet_counter++};
-
-        esp_now_send(bridge_mac, (uint8_t *)&packet, sizeof(packet));
-        vTaskDelay(pdMS_TO_TICKS(SEND_INTERVAL_MS));
     }
 }
 
@@ -269,14 +66,14 @@ void *wasm_thread_entry(void *arg)
         return NULL;
     }
 
-    // Initialize WAMR
-    static char global_heap_buf[GLOBAL_HEAP_SIZE];
+    // Map the raw container store (optional, SPIFFS is the fallback)
+    container_store_open(CONTAINER_STORE_LABEL);
 
+    // Initialize WAMR using system allocator: every instance needs its own
+    // linear memory, far more than a static pool could spare
     RuntimeInitArgs init_args;
     memset(&init_args, 0, sizeof(RuntimeInitArgs));
-    init_args.mem_alloc_type = Alloc_With_Pool;
-    init_args.mem_alloc_option.pool.heap_buf = global_heap_buf;
-    init_args.mem_alloc_option.pool.heap_size = sizeof(global_heap_buf);
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
 
     if (!wasm_runtime_full_init(&init_args))
     {
@@ -285,43 +82,62 @@ void *wasm_thread_entry(void *arg)
     }
 
     // Register native functions
-    wasm_runtime_register_natives("env", native_symbols, sizeof(native_symbols) / sizeof(NativeSymbol));
+    controller_link_register_natives();
+    filter_natives_register();
 
     ESP_LOGI(TAG, "================================================");
-    ESP_LOGI(TAG, "Loading WASM Controller: %s", file_list[0].filename);
+    ESP_LOGI(TAG, "Loading WASM Controllers");
     ESP_LOGI(TAG, "================================================");
 
-    run_wasm(wasm_file, file_size);
-    free(wasm_file);
+    if (container_manager_load_all() == 0)
+    {
+        ESP_LOGE(TAG, "No WASM containers found");
+        return NULL;
+    }
+
+    // One instance of the controller container per plant, all on the control core
+    for (int plant = 0; plant < CONFIG_CONTROLLER_CONTAINER_INSTANCES; plant++)
+    {
+        container_manager_spawn("controller", CONTROL_PERIOD_MS * 1000, SIM_CORE_CONTROL,
+                                controller_link_bind(plant));
+    }
+
+    // Live update: a new image written to SPIFFS is swapped in without
+    // stopping the control loop
+    while (container_manager_running() > 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(UPDATE_POLL_MS));
+        container_manager_check_updates();
+    }
+    container_manager_join();
+    container_manager_unload_all();
 
     return NULL;
 }
 
 void app_main(void)
 {
-    // Create mutex for thread-safe access
-    temp_mutex = xSemaphoreCreateMutex();
-    if (temp_mutex == NULL)
-    {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return;
-    }
+    controller_link_init();
+    gpio_set_direction(PIN_DUMP_BUTTON, GPIO_MODE_INPUT);
 
     // Initialize ESP-NOW
-    esp_now_wifi_init();
-    add_peer(bridge_mac);
-    esp_now_register_recv_cb(onReceiveData);
+    sim_transport_espnow_init(bridge_mac, controller_link_on_receive);
 
     ESP_LOGI(TAG, "Controller Started - WASM Control Mode");
 
+    sim_trace_start_drain(stdout, TRACE_DRAIN_MS);
+
     // Start sender task (sends heater commands to bridge)
-    xTaskCreate(sender_task, "sender_task", 4096, NULL, 5, NULL);
+    xTaskCreatePinnedToCore(sender_task, "sender_task", 4096, NULL, SIM_PRIO_COMMS, NULL,
+                            SIM_CORE_IO);
 
-    // Start WASM in a pthread (required for WAMR)
+    // Start WASM in a pthread (required for WAMR). It only loads containers
+    // and polls for updates; the instances it spawns run on the control core.
     pthread_t t;
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setstacksize(&attr, 24 * 1024);
+    sim_pipeline_pthread_cfg("wasm_manager", 24 * 1024, SIM_PRIO_HOUSEKEEPING, SIM_CORE_IO);
 
     int res = pthread_create(&t, &attr, wasm_thread_entry, NULL);
     if (res != 0)
@@ -332,4 +148,4 @@ void app_main(void)
     {
         pthread_join(t, NULL);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include "controller_link.h"
+#include "control_executor.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "simulation_data_packet.h"
+#include "sim_state.h"
+#include "latency_hist.h"
+#include "sim_packet.h"
+#include "sim_transport.h"
+#include "sim_trace.h"
+#include "wasm_export.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#define TAG "CONTROLLER"
+
+// --- STATE VARIABLES (shared with WASM) ---
+// One binding per plant (see SIM_PLANT_CHANNEL). A container reaches its
+// binding through the exec env user data; exec envs without one use plant 0.
+struct controller_binding {
+    uint32_t plant;
+    bool bound;                  // Heater commands for this plant are sent
+
+    // Lock-free, single writer (see sim_state.h)
+    sim_channel_t temperature_ch; // Written by controller_link_on_receive
+
+    // Control stage -> comms stage (see sim_pipeline.h). Heater commands
+    // (duty 0.0 .. 1.0) are stamped with the arrival time of the temperature
+    // sample they were based on. The sender takes the latest from the
+    // channel; one replaced before it was sent shows as a gap in seq.
+    sim_channel_t heater_ch;         // Latest command, written by set_heater_duty
+    uint32_t sent_heater_seq;        // Last command sent, comms stage only
+    uint32_t replaced_commands;      // Never sent, comms stage only
+
+    latency_hist_t sense_to_command; // Frame arrival -> heater command
+    char hist_name[24];
+    int64_t sensed_us;               // Stamp of the last sample handed to WASM
+};
+
+static controller_binding_t bindings[CONTROLLER_LINK_MAX_PLANTS];
+static uint32_t frame_counter = 0;
+
+// --- LATENCY (see latency_hist.h) ---
+static latency_hist_t sense_to_send; // Frame arrival -> actuator frame sent
+
+// --- SENDER WAKE-UP (controller_link_wait_commands) ---
+#ifdef ESP_PLATFORM
+static TaskHandle_t _Atomic sender_task = NULL;
+#else
+static int sender_event = -1; // eventfd: never blocks the control stage
+#endif
+
+// A new command is in a channel: wake the sender
+static void wake_sender(void)
+{
+#ifdef ESP_PLATFORM
+    TaskHandle_t task = atomic_load(&sender_task);
+    if (task)
+    {
+        xTaskNotifyGive(task);
+    }
+#else
+    uint64_t one = 1;
+    (void)!write(sender_event, &one, sizeof(one));
+#endif
+}
+
+static controller_binding_t *binding_of(void *user_data)
+{
+    controller_binding_t *b = user_data;
+    return b ? b : &bindings[0];
+}
+
+static float read_temperature(controller_binding_t *b)
+{
+    sim_sample_t sample = sim_channel_read(&b->temperature_ch);
+    b->sensed_us = sample.timestamp_us;
+    return sample.value;
+}
+
+// The heater is the bridge's: send the duty as is, clamped to 0..1
+static void set_heater_duty(controller_binding_t *b, float duty)
+{
+    if (!(duty > 0.0f))
+        duty = 0.0f;
+    if (duty > 1.0f)
+        duty = 1.0f;
+    latency_hist_record_since(&b->sense_to_command, b->sensed_us);
+    sim_channel_publish(&b->heater_ch, duty, b->sensed_us);
+    wake_sender();
+    sim_trace(SIM_TRACE_HEATER_CMD, (uint16_t)b->plant, duty);
+}
+
+// ============================================================================
+// NATIVE FUNCTIONS (Exposed to WASM)
+// ============================================================================
+
+// Get current temperature reading from the bridge
+static float host_get_temperature(wasm_exec_env_t exec_env)
+{
+    return read_temperature(binding_of(wasm_runtime_get_user_data(exec_env)));
+}
+
+// Set heater command (0 = OFF, non-zero = ON)
+static void host_set_heater(wasm_exec_env_t exec_env, int value)
+{
+    set_heater_duty(binding_of(wasm_runtime_get_user_data(exec_env)), value ? 1.0f : 0.0f);
+}
+
+// Set heater duty cycle (0.0 .. 1.0, clamped)
+static void host_set_heater_duty(wasm_exec_env_t exec_env, float duty)
+{
+    set_heater_duty(binding_of(wasm_runtime_get_user_data(exec_env)), duty);
+}
+
+// Delay function for WASM
+static void host_delay(wasm_exec_env_t exec_env, int ms)
+{
+#ifdef ESP_PLATFORM
+    vTaskDelay(pdMS_TO_TICKS(ms));
+#else
+    usleep((useconds_t)ms * 1000);
+#endif
+}
+
+// Log function for WASM
+static void host_log(wasm_exec_env_t exec_env, const char *message)
+{
+    if (message)
+    {
+        ESP_LOGI("WASM", "%s", message);
+    }
+}
+
+// Native symbol registration
+static NativeSymbol native_symbols[] = {
+    {"host_get_temperature", host_get_temperature, "()f", NULL},
+    {"host_set_heater", host_set_heater, "(i)", NULL},
+    {"host_set_heater_duty", host_set_heater_duty, "(f)", NULL},
+    {"host_delay", host_delay, "(i)", NULL},
+    {"host_log", host_log, "($)", NULL},
+};
+
+void controller_link_init(void)
+{
+    for (uint32_t i = 0; i < CONTROLLER_LINK_MAX_PLANTS; i++)
+    {
+        controller_binding_t *b = &bindings[i];
+        b->plant = i;
+        b->bound = false;
+        b->sensed_us = 0;
+        b->sent_heater_seq = 0;
+        b->replaced_commands = 0;
+        sim_channel_init(&b->temperature_ch, 25.0f);
+        sim_channel_init(&b->heater_ch, 0.0f);
+    }
+    frame_counter = 0;
+    latency_hist_init(&sense_to_send, "rx->tx");
+#ifndef ESP_PLATFORM
+    if (sender_event < 0)
+    {
+        sender_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+#endif
+    controller_link_bind(0);
+}
+
+controller_binding_t *controller_link_bind(uint32_t plant)
+{
+    if (plant >= CONTROLLER_LINK_MAX_PLANTS)
+    {
+        ESP_LOGE(TAG, "Plant %lu out of range", (unsigned long)plant);
+        return NULL;
+    }
+
+    controller_binding_t *b = &bindings[plant];
+    if (!b->bound)
+    {
+        snprintf(b->hist_name, sizeof(b->hist_name), "plant %lu rx->heater cmd",
+                 (unsigned long)plant);
+        latency_hist_init(&b->sense_to_command, b->hist_name);
+        b->bound = true;
+    }
+    return b;
+}
+
+// I/O window (see container_io.h): same channels as the natives above
+static void link_io_fill(void *user_data, container_io_t *io)
+{
+    io->sensors[CONTAINER_IO_TEMPERATURE] = read_temperature(binding_of(user_data));
+    io->sensor_count = 1;
+}
+
+static void link_io_drain(void *user_data, const container_io_t *io)
+{
+    if (io->actuator_dirty & (1u << CONTAINER_IO_HEATER))
+    {
+        set_heater_duty(binding_of(user_data), io->actuators[CONTAINER_IO_HEATER]);
+    }
+}
+
+static const control_io_ops_t link_io_ops = {
+    .fill = link_io_fill,
+    .drain = link_io_drain,
+};
+
+bool controller_link_register_natives(void)
+{
+    return wasm_runtime_register_natives("env", native_symbols,
+                                         sizeof(native_symbols) / sizeof(NativeSymbol)) &&
+           control_executor_init_io(&link_io_ops);
+}
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+// Wake the on-sample containers of the plants in `mask` (control_executor_notify)
+static void notify_plants(uint32_t mask)
+{
+    for (uint32_t plant = 0; plant < CONTROLLER_LINK_MAX_PLANTS; plant++)
+    {
+        if (mask & (1u << plant))
+        {
+            control_executor_notify(&bindings[plant]);
+        }
+    }
+    if (mask & 1u)
+    {
+        control_executor_notify(NULL); // Containers without a binding drive plant 0
+    }
+}
+
+void controller_link_on_receive(const uint8_t *data, int len)
+{
+    sim_batch_header_t header;
+    if (sim_batch_parse(data, len, &header))
+    {
+        if (header.device_id != SIM_DEVICE_BRIDGE)
+        {
+            return;
+        }
+        sim_trace(SIM_TRACE_FRAME_RX, header.device_id, header.count);
+        // Samples are stamped with the local arrival time: the bridge clock
+        // in sample.timestamp_us is not comparable with ours
+        int64_t now = esp_timer_get_time();
+        uint32_t updated = 0;
+        for (uint8_t i = 0; i < header.count; i++)
+        {
+            sim_batch_sample_t sample;
+            sim_batch_get(data, i, &sample);
+            uint32_t plant = SIM_CHANNEL_PLANT(sample.channel);
+            if (SIM_CHANNEL_KIND(sample.channel) == SIM_CHANNEL_TEMPERATURE &&
+                plant < CONTROLLER_LINK_MAX_PLANTS)
+            {
+                sim_channel_publish(&bindings[plant].temperature_ch, sample.value, now);
+                updated |= 1u << plant;
+            }
+        }
+        notify_plants(updated);
+    }
+    else if (len == sizeof(SimPacket))
+    {
+        // Legacy single-value frame
+        const SimPacket *p = (const SimPacket *)data;
+
+        // Check if this is a temperature sensor reading from the bridge (device_id=0, id=1)
+        if (p->device_id == 0 && p->id == 1)
+        {
+            // Update current temperature (lock-free, never blocks the receive context)
+            sim_channel_publish(&bindings[0].temperature_ch, p->value, esp_timer_get_time());
+            notify_plants(1u);
+        }
+    }
+}
+
+void controller_link_send_actuators(void)
+{
+    sim_batch_t batch;
+    sim_sample_t heater[CONTROLLER_LINK_MAX_PLANTS];
+
+    sim_batch_begin(&batch, SIM_DEVICE_CONTROLLER, frame_counter++);
+    for (uint32_t i = 0; i < CONTROLLER_LINK_MAX_PLANTS; i++)
+    {
+        controller_binding_t *b = &bindings[i];
+        if (!b->bound)
+            continue;
+        // Only the latest command issued since the last frame is sent
+        heater[i] = sim_channel_read(&b->heater_ch);
+        sim_batch_add(&batch, SIM_PLANT_CHANNEL(i, SIM_CHANNEL_HEATER), heater[i].value,
+                      (uint32_t)heater[i].timestamp_us);
+    }
+    sim_transport_send(batch.buf, batch.len);
+
+    // Only the first frame carrying a command measures it; repeats of the
+    // same command would just measure the send period
+    for (uint32_t i = 0; i < CONTROLLER_LINK_MAX_PLANTS; i++)
+    {
+        controller_binding_t *b = &bindings[i];
+        if (b->bound && heater[i].seq != b->sent_heater_seq)
+        {
+            b->replaced_commands += heater[i].seq - b->sent_heater_seq - 1;
+            b->sent_heater_seq = heater[i].seq;
+            latency_hist_record_since(&sense_to_send, heater[i].timestamp_us);
+        }
+    }
+}
+
+void controller_link_wait_commands(uint32_t timeout_us)
+{
+#ifdef ESP_PLATFORM
+    atomic_store(&sender_task, xTaskGetCurrentTaskHandle());
+    TickType_t ticks = pdMS_TO_TICKS(timeout_us / 1000);
+    ulTaskNotifyTake(pdTRUE, ticks ? ticks : 1);
+#else
+    // An early return (signal) only sends one more keep-alive frame
+    struct pollfd pfd = {.fd = sender_event, .events = POLLIN};
+    poll(&pfd, 1, (int)((timeout_us + 999) / 1000));
+    uint64_t count;
+    (void)!read(sender_event, &count, sizeof(count)); // Commands made meanwhile coalesce
+#endif
+}
+
+uint32_t controller_link_dropped_commands(void)
+{
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < CONTROLLER_LINK_MAX_PLANTS; i++)
+    {
+        dropped += bindings[i].replaced_commands;
+    }
+    return dropped;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Portable part of the ESP-NOW controller (controller1.c): the sensor and
+// actuator channels, the WASM natives that read and write them, and the
+// frame handling, with all I/O going through sim_transport.h. Shared by the
+// firmware and the Linux sim_controller process.
+
+#define CONTROLLER_LINK_SEND_MS    100 // Keep-alive actuator frame period when no command comes
+#define CONTROLLER_LINK_MAX_PLANTS 8   // Plants one controller can serve
+
+// Channel set of one plant. Hand it to a container with
+// wasm_runtime_set_user_data() (or control_executor_run_module()) and that
+// container's natives read and drive this plant; containers without one
+// drive plant 0.
+typedef struct controller_binding controller_binding_t;
+
+// Plant 0 is bound from the start
+void controller_link_init(void);
+
+// Bind plant `plant` (< CONTROLLER_LINK_MAX_PLANTS): its heater command is
+// sent from now on. At most one container may drive each binding. Returns
+// NULL if out of range.
+controller_binding_t *controller_link_bind(uint32_t plant);
+
+// Register host_get_temperature / host_set_heater / host_set_heater_duty /
+// host_delay / host_log
+// under "env", and the I/O window hooks for the same channels (see
+// control_executor_init_io). Call once after runtime init.
+bool controller_link_register_natives(void);
+
+// Transport receive callback: publishes temperatures from the bridge and
+// wakes the on-sample containers of the plants it updated
+// (control_executor_notify)
+void controller_link_on_receive(const uint8_t *data, int len);
+
+// Send the heater command of every bound plant to the bridge in one frame.
+// This is the comms stage (sim_pipeline.h): it sends each plant's latest
+// command and tracks what it sent, so call it from one task only.
+void controller_link_send_actuators(void);
+
+// Block the comms task until a container issues a heater command, or for
+// at most timeout_us. Looping on this and send_actuators() transmits every
+// command as soon as it is made, with a keep-alive frame when idle.
+void controller_link_wait_commands(uint32_t timeout_us);
+
+// Heater commands replaced by a newer one before the sender got to them.
+// The latest duty is always sent: only the intermediate commands are lost.
+// Read it from the comms task.
+uint32_t controller_link_dropped_commands(void);
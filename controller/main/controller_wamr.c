@@ -6,86 +6,93 @@
 #include "esp_log.h"
 #include "esp_spiffs.h"
 #include "simulation_data_packet.h"
+#include "sim_state.h"
+#include "latency_hist.h"
+#include "sim_pipeline.h"
+#include "sim_trace.h"
+#include "container_store.h"
+#include "container_loader.h"
+#include "container_budget.h"
+#include "interp_bench.h"
+#include "control_executor.h"
+#include "filter_natives.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
 #include "esp_timer.h"
-#include "esp_adc/adc_oneshot.h"
-#include "esp_adc/adc_cali.h"
-#include "esp_adc/adc_cali_scheme.h"
+#include "adc_acquire.h"
 #include "wasm_export.h" 
 #include "driver/gpio.h"
-#include "driver/ledc.h"
+#include "heater_actuator.h"
 
 #define TAG "CONTROLLER"
 
 #define PIN_ADC_CHAN ADC_CHANNEL_4 // GPIO 32 
+#define ADC_SAMPLE_HZ 20000        // Continuous DMA rate (the ESP32 minimum)
+#define ADC_OUTPUT_HZ 100          // Filtered temperatures per second
 
 #define PIN_HEATER_OUT 26
+#define HEATER_PWM_HZ  1000 // 1 ms PWM period, 13-bit duty (heater_actuator.h)
+#define HEATER_FADE_MS 20   // Hardware ramp per duty change, well inside a control period
+
+#define PIN_DUMP_BUTTON 0 // BOOT button: hold to dump the latency histograms
+
+#define CONTROL_PERIOD_MS 100 // step() period for step-ABI containers
+#define TRACE_DRAIN_MS   1000 // Telemetry trace drain period (sim_trace.h)
 
 // Define the attenuation (DB_12 allows reading up to approx 3.1V - 3.3V)
 #define ADC_ATTEN ADC_ATTEN_DB_12
 
 // --- STATE VARIABLES (shared with WASM) ---
-static float current_temp = 25.0f; // Current temperature from bridge
-static float heater_cmd = 0.0f;    // 0.0 = OFF, 1.0 = ON
-static SemaphoreHandle_t temp_mutex = NULL;
-static adc_oneshot_unit_handle_t adc_handle = NULL;
-static adc_cali_handle_t cali_handle = NULL;
-
-// --- PWM Configuration ---
-#define LEDC_TIMER              LEDC_TIMER_0
-#define LEDC_MODE               LEDC_LOW_SPEED_MODE
-#define LEDC_OUTPUT_IO          26 // Pin connected to Simulator
-#define LEDC_CHANNEL            LEDC_CHANNEL_0
-#define LEDC_DUTY_RES           LEDC_TIMER_13_BIT // Resolution (0-8191)
-#define LEDC_FREQUENCY          1000 // 1kHz Frequency (1ms period)
+// Lock-free, single writer each (see sim_state.h)
+static sim_channel_t temperature_ch; // Written by adc_acquire, window mean
+static sim_channel_t temperature_min_ch; // Window statistics, also adc_acquire
+static sim_channel_t temperature_max_ch;
+static sim_channel_t temperature_var_ch;
+static sim_channel_t heater_ch;      // Written by set_heater_duty: applied duty 0..1
+                                     // Stamped with the acquisition time of the
+                                     // temperature sample the command was based on
+
+// ADC sample -> heater duty write. Recorded by set_heater_duty only.
+static latency_hist_t sense_to_actuate;
+static int64_t sensed_us = 0; // Stamp of the last sample handed to WASM
 
 // ============================================================================
 // NATIVE FUNCTIONS (Exposed to WASM)
 // ============================================================================
 
-void init_heater_pwm() {
-    // Timer Config
-    ledc_timer_config_t ledc_timer = {
-        .speed_mode       = LEDC_MODE,
-        .timer_num        = LEDC_TIMER,
-        .duty_resolution  = LEDC_DUTY_RES,
-        .freq_hz          = LEDC_FREQUENCY, 
-        .clk_cfg          = LEDC_AUTO_CLK
-    };
-    ESP_ERROR_CHECK(ledc_timer_config(&ledc_timer));
-
-    // Channel Config
-    ledc_channel_config_t ledc_channel = {
-        .speed_mode     = LEDC_MODE,
-        .channel        = LEDC_CHANNEL,
-        .timer_sel      = LEDC_TIMER,
-        .intr_type      = LEDC_INTR_DISABLE,
-        .gpio_num       = LEDC_OUTPUT_IO,
-        .duty           = 0, // Start OFF
-        .hpoint         = 0
-    };
-    ESP_ERROR_CHECK(ledc_channel_config(&ledc_channel));
+static float read_temperature(void)
+{
+    sim_sample_t sample = sim_channel_read(&temperature_ch);
+    sensed_us = sample.timestamp_us;
+    return sample.value;
+}
+
+// The LEDC channel owns the heater pin; never drive it as a plain GPIO
+static void set_heater_duty(float duty)
+{
+    heater_actuator_set_duty(duty);
+    float applied = heater_actuator_duty();
+    latency_hist_record_since(&sense_to_actuate, sensed_us);
+    sim_channel_publish(&heater_ch, applied, sensed_us);
+    sim_trace(SIM_TRACE_HEATER_CMD, 0, applied);
 }
 
 // Get current temperature reading from the bridge
 float host_get_temperature(wasm_exec_env_t exec_env)
 {
-    float temp = 25.0f;
-    if (xSemaphoreTake(temp_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
-    {
-        temp = current_temp;
-        xSemaphoreGive(temp_mutex);
-    }
-    return temp;
+    return read_temperature();
 }
 
 // Set heater command (0= OFF, 1 = ON)
 void host_set_heater(wasm_exec_env_t exec_env, int value)
 {
-    // Clamp value to 0-1 range
-    gpio_set_level(PIN_HEATER_OUT, value);
+    set_heater_duty(value ? 1.0f : 0.0f);
+}
+
+// Set heater duty cycle (0.0 .. 1.0, clamped)
+void host_set_heater_duty(wasm_exec_env_t exec_env, float duty)
+{
+    set_heater_duty(duty);
 }
 
 // Delay function for WASM
@@ -107,110 +114,73 @@ void host_log(wasm_exec_env_t exec_env, const char *message)
 static NativeSymbol native_symbols[] = {
     {"host_get_temperature", host_get_temperature, "()f", NULL},
     {"host_set_heater", host_set_heater, "(i)", NULL},
+    {"host_set_heater_duty", host_set_heater_duty, "(f)", NULL},
     {"host_delay", host_delay, "(i)", NULL},
     {"host_log", host_log, "($)", NULL},
 };
 
-void run_wasm(uint8_t *buffer, uint32_t size)
+// A new temperature window: wake the container if it steps on samples
+static void on_temperature(void *arg)
 {
-    char error_buf[128];
-    wasm_module_t module = NULL;
-    wasm_module_inst_t module_inst = NULL;
-    wasm_exec_env_t exec_env = NULL;
-
-    // Load module
-    module = wasm_runtime_load(buffer, size, error_buf, sizeof(error_buf));
-    if (!module)
-    {
-        ESP_LOGE(TAG, "WASM load failed: %s", error_buf);
-        return;
-    }
+    control_executor_notify(NULL);
+}
 
-    // Instantiate module
-    // stack_size: WASM operand stack size
-    // heap_size: WASM app heap size (for malloc in WASM)
-    // Note: Linear memory is separate and defined in the WASM module itself
-    module_inst = wasm_runtime_instantiate(module, 16 * 1024, 16 * 1024, error_buf, sizeof(error_buf));
-    if (!module_inst)
-    {
-        ESP_LOGE(TAG, "WASM instantiation failed: %s", error_buf);
-        wasm_runtime_unload(module);
-        return;
-    }
+// I/O window (see container_io.h): same channels as the natives above
+static void io_fill(void *user_data, container_io_t *io)
+{
+    io->sensors[CONTAINER_IO_TEMPERATURE] = read_temperature();
+    io->sensors[CONTAINER_IO_TEMPERATURE_MIN] = sim_channel_value(&temperature_min_ch);
+    io->sensors[CONTAINER_IO_TEMPERATURE_MAX] = sim_channel_value(&temperature_max_ch);
+    io->sensors[CONTAINER_IO_TEMPERATURE_VAR] = sim_channel_value(&temperature_var_ch);
+    io->sensor_count = 4;
+}
 
-    // Create execution environment
-    exec_env = wasm_runtime_create_exec_env(module_inst, 8 * 1024);
-    if (!exec_env)
+static void io_drain(void *user_data, const container_io_t *io)
+{
+    if (io->actuator_dirty & (1u << CONTAINER_IO_HEATER))
     {
-        ESP_LOGE(TAG, "Exec env creation failed");
-        wasm_runtime_deinstantiate(module_inst);
-        wasm_runtime_unload(module);
-        return;
+        set_heater_duty(io->actuators[CONTAINER_IO_HEATER]);
     }
+}
 
-    ESP_LOGI(TAG, "Starting WASM Control Module...");
-
-    // Look for main function
-    wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, "main");
+static const control_io_ops_t io_ops = {
+    .fill = io_fill,
+    .drain = io_drain,
+};
 
-    if (func)
-    {
-        uint32_t args[2] = {0, 0}; // argc, argv
-        if (!wasm_runtime_call_wasm(exec_env, func, 2, args))
-        {
-            const char *exception = wasm_runtime_get_exception(module_inst);
-            if (exception && strstr(exception, "terminated"))
-            {
-                ESP_LOGW(TAG, "WASM execution terminated");
-            }
-            else
-            {
-                ESP_LOGE(TAG, "WASM exception: %s", exception ? exception : "unknown");
-            }
-        }
-        else
-        {
-            ESP_LOGI(TAG, "WASM execution completed successfully");
-        }
-    }
-    else
-    {
-        ESP_LOGE(TAG, "No main function found in WASM module");
-    }
+void run_wasm(wasm_module_t module)
+{
+    // Runs on the WAMR pthread, so a manifest's native_stack does not apply
+    container_budget_t budget;
+    container_budget_load("controller", &budget);
 
-    // Cleanup
-    wasm_runtime_destroy_exec_env(exec_env);
-    wasm_runtime_deinstantiate(module_inst);
-    wasm_runtime_unload(module);
+    ESP_LOGI(TAG, "Starting WASM Control Module...");
+    control_executor_run_module(module, "controller", &budget, CONTROL_PERIOD_MS * 1000, NULL);
 }
 
-uint8_t *load_wasm_from_spiffs(const char *filename, uint32_t *size)
+#ifdef CONFIG_CONTROLLER_INTERP_BENCH
+// Interpreter A/B benchmark: runs the bytecode container (never the AOT
+// image) against the bench natives and logs cycles and heap use.
+static void run_interp_bench(void)
 {
-    ESP_LOGI(TAG, "Opening file: %s", filename);
-    FILE *f = fopen(filename, "rb");
-    if (!f)
+    uint32_t size = 0;
+    uint8_t *image = load_wasm_from_spiffs("/spiffs/controller.wasm", &size);
+    if (!image)
     {
-        ESP_LOGE(TAG, "Failed to open file");
-        return NULL;
+        ESP_LOGE(TAG, "Failed to load WASM file from SPIFFS");
+        return;
     }
 
-    fseek(f, 0, SEEK_END);
-    long fsize = ftell(f);
-    fseek(f, 0, SEEK_SET);
+    interp_bench_register_natives();
 
-    uint8_t *buffer = malloc(fsize);
-    if (!buffer)
+    interp_bench_result_t result;
+    if (interp_bench_run(image, size, CONFIG_CONTROLLER_INTERP_BENCH_ITERATIONS, &result))
     {
-        ESP_LOGE(TAG, "Malloc failed");
-        fclose(f);
-        return NULL;
+        interp_bench_report(&result);
     }
-
-    fread(buffer, 1, fsize, f);
-    fclose(f);
-    *size = (uint32_t)fsize;
-    return buffer;
+    free(image);
 }
+#endif
 
 void *wasm_thread_entry(void *arg)
 {
@@ -226,6 +196,9 @@ void *wasm_thread_entry(void *arg)
         return NULL;
     }
 
+    // Map the raw container store (optional, SPIFFS is the fallback)
+    container_store_open(CONTAINER_STORE_LABEL);
+
     // Initialize WAMR using system allocator (more memory available than static pool)
     RuntimeInitArgs init_args;
     memset(&init_args, 0, sizeof(RuntimeInitArgs));
@@ -237,119 +210,99 @@ void *wasm_thread_entry(void *arg)
         return NULL;
     }
 
+#ifdef CONFIG_CONTROLLER_INTERP_BENCH
+    run_interp_bench();
+    return NULL;
+#else
     // Register native functions
     wasm_runtime_register_natives("env", native_symbols, sizeof(native_symbols) / sizeof(NativeSymbol));
+    control_executor_init_io(&io_ops);
+    filter_natives_register();
 
     ESP_LOGI(TAG, "================================================");
     ESP_LOGI(TAG, "Loading WASM container from SPIFFS...");
     ESP_LOGI(TAG, "================================================");
 
-    uint32_t file_size = 0;
-    uint8_t *wasm_file = load_wasm_from_spiffs("/spiffs/controller.wasm", &file_size);
-    if (!wasm_file)
+    uint8_t *wasm_file = NULL;
+    wasm_module_t module = load_container("controller", &wasm_file);
+    if (!module)
     {
-        ESP_LOGE(TAG, "Failed to load WASM file from SPIFFS");
+        ESP_LOGE(TAG, "Failed to load WASM container from SPIFFS");
+        return NULL;
     }
-    run_wasm(wasm_file, file_size);
+    run_wasm(module);
+    wasm_runtime_unload(module);
     free(wasm_file);
     return NULL;
+#endif
 }
-void init_adc()
-{
-    // ------------- 1. Setup ADC (Hardware) -------------
-    adc_oneshot_unit_init_cfg_t init_config = {
-        .unit_id = ADC_UNIT_1,
-        .clk_src = 0,
-    };
-    ESP_ERROR_CHECK(adc_oneshot_new_unit(&init_config, &adc_handle));
-
-    // Configure the specific channel (Pin 33)
-    adc_oneshot_chan_cfg_t config = {
-        .bitwidth = ADC_BITWIDTH_DEFAULT,
-        .atten = ADC_ATTEN,
-    };
-
-    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc_handle, PIN_ADC_CHAN, &config));
-}
-
-void calibrate_adc()
+// Polls the BOOT button; sampling itself runs in adc_acquire
+void button_task(void *arg)
 {
-    // ------------- 2. Setup Calibration (Software) -------------
-    // This loads the factory reference voltage from the chip's eFuse
-    ESP_LOGI("CTRL", "Setting up calibration scheme...");
-
-    adc_cali_line_fitting_config_t cali_config = {
-        .unit_id = ADC_UNIT_1,
-        .atten = ADC_ATTEN,
-        .bitwidth = ADC_BITWIDTH_DEFAULT,
-    };
-
-    // Check if calibration is successful
-    esp_err_t ret = adc_cali_create_scheme_line_fitting(&cali_config, &cali_handle);
-    if (ret == ESP_OK)
-    {
-        ESP_LOGI(TAG, "Calibration Success");
-    }
-    else if (ret == ESP_ERR_NOT_SUPPORTED)
-    {
-        ESP_LOGW(TAG, "eFuse not burnt, skip software calibration");
-    }
-    else
-    {
-        ESP_LOGE(TAG, "Invalid arg or no memory");
-    }
-}
-
-void reader_task(void *arg)
-{
-    init_adc();
-    calibrate_adc();
     while (1)
     {
-        int adc_raw;
-        ESP_ERROR_CHECK(adc_oneshot_read(adc_handle, PIN_ADC_CHAN, &adc_raw));
-
-        // --- B. Convert to Calibrated Voltage ---
-        int voltage_mv = 0;
-
-        // This function converts the raw "S-curve" to linear Millivolts
-        ESP_ERROR_CHECK(adc_cali_raw_to_voltage(cali_handle, adc_raw, &voltage_mv));
-
-        // --- C. Convert Voltage to Temperature ---
-        // NEW LOGIC: We map 3300mV (3.3V) to 100 degrees Celsius
-        float temperature = ((float)voltage_mv / 3300.0f) * 100.0f;
-
-        if (xSemaphoreTake(temp_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+        if (gpio_get_level(PIN_DUMP_BUTTON) == 0)
         {
-            current_temp = temperature;
-            xSemaphoreGive(temp_mutex);
+            latency_hist_dump_all();
+            sim_stage_report(adc_acquire_stage());
+            ESP_LOGI(TAG, "ADC: %lu windows, %lu DMA overflows",
+                     (unsigned long)adc_acquire_windows(), (unsigned long)adc_acquire_overflows());
+
+            heater_actuator_stats_t hs;
+            heater_actuator_stats(&hs);
+            ESP_LOGI(TAG, "Heater: duty %.3f | %lu applied, %lu unchanged, %lu superseded fades",
+                     heater_actuator_duty(), (unsigned long)hs.applied,
+                     (unsigned long)hs.unchanged, (unsigned long)hs.superseded);
         }
-
-        // Print both Raw and Calibrated Voltage for debugging
-        ESP_LOGI(TAG, "Raw: %d | Volts: %d mV | Temp: %.1f C | Cmd: %d",
-                 adc_raw, voltage_mv, temperature, heater_cmd);
-
         vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
 
 void app_main(void)
 {
-
-    temp_mutex = xSemaphoreCreateMutex();
-    if (temp_mutex == NULL)
+    sim_channel_init(&temperature_ch, 25.0f);
+    sim_channel_init(&temperature_min_ch, 25.0f);
+    sim_channel_init(&temperature_max_ch, 25.0f);
+    sim_channel_init(&temperature_var_ch, 0.0f);
+    sim_channel_init(&heater_ch, 0.0f);
+    latency_hist_init(&sense_to_actuate, "adc->heater duty");
+
+    gpio_set_direction(PIN_DUMP_BUTTON, GPIO_MODE_INPUT);
+    heater_actuator_config_t heater_cfg = {
+        .gpio = PIN_HEATER_OUT,
+        .freq_hz = HEATER_PWM_HZ,
+        .fade_ms = HEATER_FADE_MS,
+    };
+    if (!heater_actuator_init(&heater_cfg))
     {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return;
+        ESP_LOGE(TAG, "Heater PWM unavailable: heater stays off");
     }
+    sim_trace_start_drain(stdout, TRACE_DRAIN_MS);
 
-    gpio_set_direction(PIN_HEATER_OUT, GPIO_MODE_OUTPUT);
-    init_heater_pwm();
-    xTaskCreate(reader_task, "ADC Reader Task", 4096, NULL, 5, NULL);
+    // We map 3300mV (3.3V) to 100 degrees Celsius
+    adc_acquire_config_t adc_cfg = {
+        .unit = ADC_UNIT_1,
+        .channel = PIN_ADC_CHAN,
+        .atten = ADC_ATTEN,
+        .sample_hz = ADC_SAMPLE_HZ,
+        .output_hz = ADC_OUTPUT_HZ,
+        .units_per_mv = 100.0f / 3300.0f,
+        .mean = &temperature_ch,
+        .min = &temperature_min_ch,
+        .max = &temperature_max_ch,
+        .variance = &temperature_var_ch,
+        .on_published = on_temperature,
+    };
+    // Acquisition and housekeeping on the IO core, the control law alone on
+    // the other (sim_pipeline.h)
+    adc_acquire_start(&adc_cfg);
+    xTaskCreatePinnedToCore(button_task, "button_task", 3072, NULL, SIM_PRIO_HOUSEKEEPING, NULL,
+                            SIM_CORE_IO);
     pthread_t t;
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setstacksize(&attr, 24 * 1024);
+    sim_pipeline_pthread_cfg("wasm_control", 24 * 1024, SIM_PRIO_CONTROL, SIM_CORE_CONTROL);
 
     int res = pthread_create(&t, &attr, wasm_thread_entry, NULL);
     if (res != 0)
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+
+// Free-running CPU cycle counter for timing short code sections.
+// 32 bits wide (wraps after ~26 s at 160 MHz on the ESP32), so only use it
+// for differences: `uint32_t elapsed = cycle_count() - start;`
+//
+// On the ESP32 each core has its own counter: time sections on a task pinned
+// to one core, or a migration in between corrupts that sample.
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+
+static inline uint32_t cycle_count(void)
+{
+    return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+// Counter ticks per microsecond
+static inline uint32_t cycle_counter_per_us(void)
+{
+    return esp_rom_get_cpu_ticks_per_us();
+}
+#elif defined(__x86_64__) || defined(__i386__)
+#include <time.h>
+#include <x86intrin.h>
+
+static inline uint32_t cycle_count(void)
+{
+    return (uint32_t)__rdtsc();
+}
+
+// TSC ticks per microsecond, measured against the monotonic clock once
+static inline uint32_t cycle_counter_per_us(void)
+{
+    static uint32_t per_us = 0;
+    if (per_us == 0)
+    {
+        struct timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        uint32_t c0 = cycle_count();
+        long elapsed_ns;
+        do
+        {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            elapsed_ns = (now.tv_sec - start.tv_sec) * 1000000000L + (now.tv_nsec - start.tv_nsec);
+        } while (elapsed_ns < 10000000L); // 10 ms
+        per_us = (uint32_t)((uint64_t)(cycle_count() - c0) * 1000 / elapsed_ns);
+        if (per_us == 0)
+            per_us = 1;
+    }
+    return per_us;
+}
+#else
+#include <time.h>
+
+// No portable cycle counter: fall back to nanoseconds
+static inline uint32_t cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static inline uint32_t cycle_counter_per_us(void)
+{
+    return 1000;
+}
+#endif
@@ -0,0 +1,158 @@
+#include <stddef.h>
+#include "filter_natives.h"
+#include "signal_filter.h"
+#include "wasm_export.h"
+
+// Native address of [offset, offset + size) in the caller's memory, NULL
+// (with an exception set) if it is not all inside or not aligned for the
+// type the kernel accesses it as. Linear memory itself is page aligned.
+static void *app_ptr(wasm_exec_env_t exec_env, uint32_t offset, uint64_t size, size_t align)
+{
+    wasm_module_inst_t inst = wasm_runtime_get_module_inst(exec_env);
+    if (!wasm_runtime_validate_app_addr(inst, offset, size))
+        return NULL;
+    if (offset % align != 0)
+    {
+        wasm_runtime_set_exception(inst, "misaligned filter buffer");
+        return NULL;
+    }
+    return wasm_runtime_addr_app_to_native(inst, offset);
+}
+
+// `n` objects of `type` at container address `offset`, inside a native
+#define APP_ARRAY(offset, type, n) \
+    app_ptr(exec_env, offset, (uint64_t)(n) * sizeof(type), _Alignof(type))
+
+// Ring filters index their history with len/pos from container memory
+static bool ring_ok(wasm_exec_env_t exec_env, uint32_t len, uint32_t pos, uint32_t max)
+{
+    if (len >= 1 && len <= max && pos < len)
+        return true;
+    wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env), "corrupt filter state");
+    return false;
+}
+
+#define RING_OK_MA(s)     ring_ok(exec_env, (s)->len, (s)->pos, SF_MA_MAX)
+#define RING_OK_MEDIAN(s) ring_ok(exec_env, (s)->len, (s)->pos, SF_MEDIAN_MAX)
+#define ANY_OK(s)         true
+
+// One wrapper per block kernel: (state, in, out, n), all container addresses
+#define BLOCK_NATIVE(fn, state_t, sample_t, check)                                             \
+    static void native_##fn(wasm_exec_env_t exec_env, uint32_t state, uint32_t in, uint32_t out, \
+                            uint32_t n)                                                         \
+    {                                                                                           \
+        state_t *s = APP_ARRAY(state, state_t, 1);                                              \
+        const sample_t *src = APP_ARRAY(in, sample_t, n);                                       \
+        sample_t *dst = APP_ARRAY(out, sample_t, n);                                            \
+        if (s && src && dst && check(s))                                                        \
+            fn(s, src, dst, n);                                                                 \
+    }
+
+BLOCK_NATIVE(sf_ma_f32, sf_ma_f32_t, float, RING_OK_MA)
+BLOCK_NATIVE(sf_ema_f32, sf_ema_f32_t, float, ANY_OK)
+BLOCK_NATIVE(sf_biquad_f32, sf_biquad_f32_t, float, ANY_OK)
+BLOCK_NATIVE(sf_median_f32, sf_median_f32_t, float, RING_OK_MEDIAN)
+BLOCK_NATIVE(sf_ma_q15, sf_ma_q15_t, int16_t, RING_OK_MA)
+BLOCK_NATIVE(sf_ema_q15, sf_ema_q15_t, int16_t, ANY_OK)
+BLOCK_NATIVE(sf_biquad_q15, sf_biquad_q15_t, int16_t, ANY_OK)
+BLOCK_NATIVE(sf_median_q15, sf_median_q15_t, int16_t, RING_OK_MEDIAN)
+BLOCK_NATIVE(sf_ma_q31, sf_ma_q31_t, int32_t, RING_OK_MA)
+BLOCK_NATIVE(sf_ema_q31, sf_ema_q31_t, int32_t, ANY_OK)
+BLOCK_NATIVE(sf_biquad_q31, sf_biquad_q31_t, int32_t, ANY_OK)
+BLOCK_NATIVE(sf_median_q31, sf_median_q31_t, int32_t, RING_OK_MEDIAN)
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+static void native_sf_biquad_lowpass(wasm_exec_env_t exec_env, uint32_t coeffs, float fc_hz,
+                                     float fs_hz, float q)
+{
+    float *c = APP_ARRAY(coeffs, float, SF_BIQUAD_COEFFS);
+    if (c)
+        sf_biquad_lowpass(c, fc_hz, fs_hz, q);
+}
+
+// Window inits: (state, len, initial)
+#define WINDOW_INIT_NATIVE(fn, state_t, initial_t)                                          \
+    static void native_##fn(wasm_exec_env_t exec_env, uint32_t state, uint32_t len,          \
+                            initial_t initial)                                               \
+    {                                                                                        \
+        state_t *s = APP_ARRAY(state, state_t, 1);                                           \
+        if (s)                                                                               \
+            fn(s, len, initial);                                                             \
+    }
+
+// EMA inits: (state, alpha, initial)
+#define EMA_INIT_NATIVE(fn, state_t, initial_t)                                             \
+    static void native_##fn(wasm_exec_env_t exec_env, uint32_t state, float alpha,           \
+                            initial_t initial)                                               \
+    {                                                                                        \
+        state_t *s = APP_ARRAY(state, state_t, 1);                                           \
+        if (s)                                                                               \
+            fn(s, alpha, initial);                                                           \
+    }
+
+// Biquad inits: (state, coeffs, initial)
+#define BIQUAD_INIT_NATIVE(fn, state_t, initial_t)                                          \
+    static void native_##fn(wasm_exec_env_t exec_env, uint32_t state, uint32_t coeffs,       \
+                            initial_t initial)                                               \
+    {                                                                                        \
+        state_t *s = APP_ARRAY(state, state_t, 1);                                           \
+        const float *c = APP_ARRAY(coeffs, float, SF_BIQUAD_COEFFS);                         \
+        if (s && c)                                                                          \
+            fn(s, c, initial);                                                               \
+    }
+
+// Fixed-point initial values arrive as i32 and are narrowed by the call
+WINDOW_INIT_NATIVE(sf_ma_f32_init, sf_ma_f32_t, float)
+WINDOW_INIT_NATIVE(sf_median_f32_init, sf_median_f32_t, float)
+WINDOW_INIT_NATIVE(sf_ma_q15_init, sf_ma_q15_t, int32_t)
+WINDOW_INIT_NATIVE(sf_median_q15_init, sf_median_q15_t, int32_t)
+WINDOW_INIT_NATIVE(sf_ma_q31_init, sf_ma_q31_t, int32_t)
+WINDOW_INIT_NATIVE(sf_median_q31_init, sf_median_q31_t, int32_t)
+EMA_INIT_NATIVE(sf_ema_f32_init, sf_ema_f32_t, float)
+EMA_INIT_NATIVE(sf_ema_q15_init, sf_ema_q15_t, int32_t)
+EMA_INIT_NATIVE(sf_ema_q31_init, sf_ema_q31_t, int32_t)
+BIQUAD_INIT_NATIVE(sf_biquad_f32_init, sf_biquad_f32_t, float)
+BIQUAD_INIT_NATIVE(sf_biquad_q15_init, sf_biquad_q15_t, int32_t)
+BIQUAD_INIT_NATIVE(sf_biquad_q31_init, sf_biquad_q31_t, int32_t)
+
+#define SYMBOL(fn, signature) {#fn, native_##fn, signature, NULL}
+
+static NativeSymbol filter_symbols[] = {
+    SYMBOL(sf_biquad_lowpass, "(ifff)"),
+
+    SYMBOL(sf_ma_f32_init, "(iif)"),
+    SYMBOL(sf_ema_f32_init, "(iff)"),
+    SYMBOL(sf_biquad_f32_init, "(iif)"),
+    SYMBOL(sf_median_f32_init, "(iif)"),
+    SYMBOL(sf_ma_f32, "(iiii)"),
+    SYMBOL(sf_ema_f32, "(iiii)"),
+    SYMBOL(sf_biquad_f32, "(iiii)"),
+    SYMBOL(sf_median_f32, "(iiii)"),
+
+    SYMBOL(sf_ma_q15_init, "(iii)"),
+    SYMBOL(sf_ema_q15_init, "(ifi)"),
+    SYMBOL(sf_biquad_q15_init, "(iii)"),
+    SYMBOL(sf_median_q15_init, "(iii)"),
+    SYMBOL(sf_ma_q15, "(iiii)"),
+    SYMBOL(sf_ema_q15, "(iiii)"),
+    SYMBOL(sf_biquad_q15, "(iiii)"),
+    SYMBOL(sf_median_q15, "(iiii)"),
+
+    SYMBOL(sf_ma_q31_init, "(iii)"),
+    SYMBOL(sf_ema_q31_init, "(ifi)"),
+    SYMBOL(sf_biquad_q31_init, "(iii)"),
+    SYMBOL(sf_median_q31_init, "(iii)"),
+    SYMBOL(sf_ma_q31, "(iiii)"),
+    SYMBOL(sf_ema_q31, "(iiii)"),
+    SYMBOL(sf_biquad_q31, "(iiii)"),
+    SYMBOL(sf_median_q31, "(iiii)"),
+};
+
+bool filter_natives_register(void)
+{
+    return wasm_runtime_register_natives("env", filter_symbols,
+                                         sizeof(filter_symbols) / sizeof(NativeSymbol));
+}
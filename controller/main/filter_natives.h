@@ -0,0 +1,15 @@
+#pragma once
+#include <stdbool.h>
+
+// The signal_filter.h library as host natives (module "env"), under the
+// same names and signatures. Containers built with FILTER_LIB=native import
+// them instead of linking signal_filter.c: the kernels then run as native
+// code on state kept in the container's linear memory, which pays off under
+// the interpreter once a block holds more than a few samples.
+//
+// Every pointer is bounds-checked against the caller's memory, and ring
+// indices read back from the state are checked before use: a bad call traps
+// the container instead of touching host memory.
+
+// Register the natives. Call once after runtime init.
+bool filter_natives_register(void);
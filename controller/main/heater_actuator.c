@@ -0,0 +1,174 @@
+#include <stddef.h>
+#include "heater_actuator.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "driver/ledc.h"
+#include "esp_attr.h"
+#endif
+
+#define TAG "HEATER"
+
+static heater_actuator_config_t cfg;
+static volatile uint32_t duty_raw = 0; // Applied duty, 0..HEATER_ACTUATOR_DUTY_MAX
+static heater_actuator_stats_t stats;
+
+// ============================================================================
+// LEDC BACKEND
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+#define LEDC_TIMER   LEDC_TIMER_0
+#define LEDC_MODE    LEDC_LOW_SPEED_MODE
+#define LEDC_CHANNEL LEDC_CHANNEL_0
+
+static volatile bool fading = false; // Cleared by the fade-end interrupt, for the stats
+
+static bool IRAM_ATTR on_fade_end(const ledc_cb_param_t *param, void *user_arg)
+{
+    if (param->event == LEDC_FADE_END_EVT)
+        fading = false;
+    return false;
+}
+
+static bool backend_init(void)
+{
+    ledc_timer_config_t timer = {
+        .speed_mode = LEDC_MODE,
+        .timer_num = LEDC_TIMER,
+        .duty_resolution = HEATER_ACTUATOR_DUTY_BITS,
+        .freq_hz = cfg.freq_hz,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    if (ledc_timer_config(&timer) != ESP_OK)
+        return false;
+
+    ledc_channel_config_t channel = {
+        .speed_mode = LEDC_MODE,
+        .channel = LEDC_CHANNEL,
+        .timer_sel = LEDC_TIMER,
+        .intr_type = LEDC_INTR_DISABLE,
+        .gpio_num = cfg.gpio,
+        .duty = 0, // Start OFF
+        .hpoint = 0,
+    };
+    if (ledc_channel_config(&channel) != ESP_OK)
+        return false;
+
+    if (cfg.fade_ms > 0)
+    {
+        ledc_cbs_t cbs = {.fade_cb = on_fade_end};
+        if (ledc_fade_func_install(0) != ESP_OK ||
+            ledc_cb_register(LEDC_MODE, LEDC_CHANNEL, &cbs, NULL) != ESP_OK)
+            return false;
+    }
+    return true;
+}
+
+// False if nothing was written
+static bool backend_apply(uint32_t raw)
+{
+    if (cfg.fade_ms == 0)
+    {
+        // Register writes only: the new duty takes effect at the next period
+        ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, raw);
+        ledc_update_duty(LEDC_MODE, LEDC_CHANNEL);
+        return true;
+    }
+
+    // Starting a fade over a running one would wait for it to finish, and
+    // skipping the command would lose it: stop the old fade where it is.
+    // Stopping an idle channel is a no-op, so a late fade-end interrupt
+    // leaving `fading` stale does no harm.
+    if (fading)
+        stats.superseded++;
+    ledc_fade_stop(LEDC_MODE, LEDC_CHANNEL);
+    fading = true;
+    if (ledc_set_fade_time_and_start(LEDC_MODE, LEDC_CHANNEL, raw, cfg.fade_ms,
+                                     LEDC_FADE_NO_WAIT) != ESP_OK)
+    {
+        fading = false;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// MOCK BACKEND
+// ============================================================================
+
+#else
+static void (*mock_sink)(float duty, void *arg) = NULL;
+static void *mock_arg = NULL;
+
+void heater_actuator_mock_set_sink(void (*sink)(float duty, void *arg), void *arg)
+{
+    mock_arg = arg;
+    mock_sink = sink;
+}
+
+static bool backend_init(void)
+{
+    return true;
+}
+
+static bool backend_apply(uint32_t raw)
+{
+    if (mock_sink)
+        mock_sink((float)raw / HEATER_ACTUATOR_DUTY_MAX, mock_arg);
+    return true;
+}
+#endif
+
+// ============================================================================
+// ACTUATOR
+// ============================================================================
+
+bool heater_actuator_init(const heater_actuator_config_t *config)
+{
+    cfg = *config;
+    duty_raw = 0;
+    stats = (heater_actuator_stats_t){0};
+
+    if (!backend_init())
+    {
+        ESP_LOGE(TAG, "PWM setup failed on GPIO %d", cfg.gpio);
+        return false;
+    }
+    ESP_LOGI(TAG, "GPIO %d: %lu Hz PWM, %d-bit duty, %s", cfg.gpio, (unsigned long)cfg.freq_hz,
+             HEATER_ACTUATOR_DUTY_BITS, cfg.fade_ms ? "hardware fades" : "step changes");
+    return true;
+}
+
+void heater_actuator_set_duty(float duty)
+{
+    // Also maps NaN to 0
+    if (!(duty > 0.0f))
+        duty = 0.0f;
+    if (duty > 1.0f)
+        duty = 1.0f;
+    uint32_t raw = (uint32_t)(duty * HEATER_ACTUATOR_DUTY_MAX + 0.5f);
+
+    if (raw == duty_raw)
+    {
+        stats.unchanged++;
+        return;
+    }
+    if (!backend_apply(raw))
+    {
+        ESP_LOGW(TAG, "PWM update failed");
+        return;
+    }
+    duty_raw = raw;
+    stats.applied++;
+}
+
+float heater_actuator_duty(void)
+{
+    return (float)duty_raw / HEATER_ACTUATOR_DUTY_MAX;
+}
+
+void heater_actuator_stats(heater_actuator_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Heater actuator: proportional drive through a hardware PWM channel.
+//
+// On the ESP32 the heater pin belongs to one LEDC channel (nothing else may
+// drive the GPIO). A duty command is quantized to HEATER_ACTUATOR_DUTY_BITS
+// and written to the channel registers; the hardware latches it at the next
+// PWM period, or ramps to it over fade_ms with a hardware fade. Either way
+// the caller never waits: no mutex, no fade completion.
+//
+// Linux builds get a mock backend with the same quantization, which hands
+// every applied duty to a sink (the simulated plant, a test recorder).
+//
+// Like sim_channel_t, there is exactly ONE writer (the control task); any
+// task may read the applied duty and the statistics.
+
+#define HEATER_ACTUATOR_DUTY_BITS 13
+#define HEATER_ACTUATOR_DUTY_MAX  ((1u << HEATER_ACTUATOR_DUTY_BITS) - 1)
+
+typedef struct {
+    int gpio;
+    uint32_t freq_hz;  // PWM frequency; 13 bits of resolution allow up to ~9.7 kHz
+    uint32_t fade_ms;  // 0: step changes. Otherwise keep it below the control
+                       // period, or commands arriving mid-fade cut fades short
+} heater_actuator_config_t;
+
+typedef struct {
+    uint32_t applied;   // Duty changes written to the backend
+    uint32_t unchanged; // Commands equal to the current duty (no write)
+    uint32_t superseded; // Commands that cut a running fade short
+} heater_actuator_stats_t;
+
+bool heater_actuator_init(const heater_actuator_config_t *config);
+
+// Command a duty cycle, clamped to 0..1. A fade still running is stopped
+// where it is and a new one starts from there towards the new duty.
+void heater_actuator_set_duty(float duty);
+
+// Last applied duty, after quantization
+float heater_actuator_duty(void);
+
+void heater_actuator_stats(heater_actuator_stats_t *stats);
+
+#ifndef ESP_PLATFORM
+// Mock backend: receive every applied duty (0..1, quantized). NULL detaches.
+void heater_actuator_mock_set_sink(void (*sink)(float duty, void *arg), void *arg);
+#endif
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <string.h>
+#include "interp_bench.h"
+#include "cycle_counter.h"
+#include "control_executor.h"
+#include "esp_log.h"
+#include "wasm_export.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#else
+#include <malloc.h>
+#endif
+
+#define TAG "BENCH"
+
+#ifdef CONFIG_WAMR_INTERP_FAST
+#define INTERP_MODE "fast"
+#else
+#define INTERP_MODE "classic"
+#endif
+
+// Synthetic plant: triangle wave 45..55 C, so the 50 +/- 1 C bang-bang law
+// switches the heater twice per period.
+#define WAVE_PERIOD 64
+#define WAVE_LOW    45.0f
+#define WAVE_HIGH   55.0f
+
+static uint32_t iteration_limit = 0;
+static uint32_t iteration = 0;
+static uint32_t last_cycles = 0;
+static interp_bench_result_t *current = NULL;
+
+static size_t heap_used(void)
+{
+#ifdef ESP_PLATFORM
+    return heap_caps_get_total_size(MALLOC_CAP_DEFAULT) - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+#else
+    return mallinfo2().uordblks;
+#endif
+}
+
+// ============================================================================
+// BENCH NATIVES (same signatures as the control natives)
+// ============================================================================
+
+static float bench_get_temperature(wasm_exec_env_t exec_env)
+{
+    uint32_t phase = iteration % WAVE_PERIOD;
+    uint32_t half = WAVE_PERIOD / 2;
+    float t = (phase < half) ? (float)phase / half : (float)(WAVE_PERIOD - phase) / half;
+    return WAVE_LOW + t * (WAVE_HIGH - WAVE_LOW);
+}
+
+static void bench_set_heater(wasm_exec_env_t exec_env, int value)
+{
+    (void)value;
+}
+
+static void bench_set_heater_duty(wasm_exec_env_t exec_env, float duty)
+{
+    (void)duty;
+}
+
+// One call per control iteration: record the cycles since the previous one
+// and stop the container once enough iterations have been measured.
+static void bench_delay(wasm_exec_env_t exec_env, int ms)
+{
+    uint32_t now = cycle_count();
+    (void)ms;
+
+    if (iteration > 0)
+    {
+        uint32_t cycles = now - last_cycles;
+        if (cycles < current->cycles_min)
+            current->cycles_min = cycles;
+        if (cycles > current->cycles_max)
+            current->cycles_max = cycles;
+        current->cycles_total += cycles;
+        current->iterations++;
+    }
+
+    if (++iteration > iteration_limit)
+    {
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env), "bench done");
+        return;
+    }
+    last_cycles = cycle_count();
+}
+
+static void bench_log(wasm_exec_env_t exec_env, const char *message)
+{
+    (void)message;
+}
+
+static NativeSymbol bench_symbols[] = {
+    {"host_get_temperature", bench_get_temperature, "()f", NULL},
+    {"host_set_heater", bench_set_heater, "(i)", NULL},
+    {"host_set_heater_duty", bench_set_heater_duty, "(f)", NULL},
+    {"host_delay", bench_delay, "(i)", NULL},
+    {"host_log", bench_log, "($)", NULL},
+};
+
+// Step-ABI container: one timed step() call per iteration, driven like
+// control_executor.c drives it.
+static bool run_step_container(wasm_module_inst_t module_inst, wasm_exec_env_t exec_env)
+{
+    wasm_function_inst_t init_func = wasm_runtime_lookup_function(module_inst, "init");
+    wasm_function_inst_t step_func = wasm_runtime_lookup_function(module_inst, "step");
+    float dt = 0.1f;
+    uint32_t argv[1];
+
+    if (init_func && !wasm_runtime_call_wasm(exec_env, init_func, 0, NULL))
+    {
+        ESP_LOGE(TAG, "init failed: %s", wasm_runtime_get_exception(module_inst));
+        return false;
+    }
+
+    for (iteration = 0; iteration < iteration_limit; iteration++)
+    {
+        memcpy(&argv[0], &dt, sizeof(float));
+        uint32_t start = cycle_count();
+        bool ok = wasm_runtime_call_wasm(exec_env, step_func, 1, argv);
+        uint32_t cycles = cycle_count() - start;
+        if (!ok)
+        {
+            ESP_LOGE(TAG, "step failed: %s", wasm_runtime_get_exception(module_inst));
+            return false;
+        }
+
+        if (cycles < current->cycles_min)
+            current->cycles_min = cycles;
+        if (cycles > current->cycles_max)
+            current->cycles_max = cycles;
+        current->cycles_total += cycles;
+        current->iterations++;
+    }
+    return true;
+}
+
+// Legacy container: main() loops until bench_delay() stops it.
+static bool run_main_container(wasm_module_inst_t module_inst, wasm_exec_env_t exec_env)
+{
+    wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, "main");
+    if (!func)
+    {
+        ESP_LOGE(TAG, "No step or main function found");
+        return false;
+    }
+
+    uint32_t args[2] = {0, 0};
+    wasm_runtime_call_wasm(exec_env, func, 2, args);
+
+    const char *exception = wasm_runtime_get_exception(module_inst);
+    bool ok = exception && strstr(exception, "bench done");
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Container stopped early: %s", exception ? exception : "returned");
+    }
+    return ok;
+}
+
+bool interp_bench_register_natives(void)
+{
+    return wasm_runtime_register_natives("env", bench_symbols,
+                                         sizeof(bench_symbols) / sizeof(NativeSymbol));
+}
+
+bool interp_bench_run(uint8_t *image, uint32_t size, uint32_t iterations,
+                      interp_bench_result_t *result)
+{
+    char error_buf[128];
+    bool ok = false;
+
+    memset(result, 0, sizeof(*result));
+    result->mode = INTERP_MODE;
+    result->image_size = size;
+    result->cycles_min = UINT32_MAX;
+
+    size_t heap_before = heap_used();
+    wasm_module_t module = wasm_runtime_load(image, size, error_buf, sizeof(error_buf));
+    if (!module)
+    {
+        ESP_LOGE(TAG, "WASM load failed: %s", error_buf);
+        return false;
+    }
+    size_t heap_loaded = heap_used();
+
+    // Same budgets as the control executor gives a container without a
+    // manifest (container_budget_default)
+    wasm_module_inst_t module_inst = wasm_runtime_instantiate(module, CONTAINER_EXEC_STACK_SIZE,
+                                                              CONTAINER_HEAP_SIZE,
+                                                              error_buf, sizeof(error_buf));
+    if (!module_inst)
+    {
+        ESP_LOGE(TAG, "WASM instantiation failed: %s", error_buf);
+        wasm_runtime_unload(module);
+        return false;
+    }
+
+    wasm_exec_env_t exec_env = wasm_runtime_create_exec_env(module_inst, CONTAINER_EXEC_STACK_SIZE);
+    if (exec_env)
+    {
+        result->load_bytes = heap_loaded - heap_before;
+        result->instantiate_bytes = heap_used() - heap_loaded;
+
+        current = result;
+        iteration = 0;
+        iteration_limit = iterations;
+
+        if (wasm_runtime_lookup_function(module_inst, "step"))
+        {
+            ok = run_step_container(module_inst, exec_env);
+        }
+        else
+        {
+            ok = run_main_container(module_inst, exec_env);
+        }
+        current = NULL;
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Exec env creation failed");
+    }
+
+    if (exec_env)
+        wasm_runtime_destroy_exec_env(exec_env);
+    wasm_runtime_deinstantiate(module_inst);
+    wasm_runtime_unload(module);
+    return ok;
+}
+
+void interp_bench_report(const interp_bench_result_t *r)
+{
+    uint32_t mean = r->iterations ? (uint32_t)(r->cycles_total / r->iterations) : 0;
+
+    ESP_LOGI(TAG, "interpreter      : %s", r->mode);
+    ESP_LOGI(TAG, "bytecode size    : %lu bytes", (unsigned long)r->image_size);
+    ESP_LOGI(TAG, "load heap        : %lu bytes", (unsigned long)r->load_bytes);
+    ESP_LOGI(TAG, "instantiate heap : %lu bytes", (unsigned long)r->instantiate_bytes);
+    ESP_LOGI(TAG, "iterations       : %lu", (unsigned long)r->iterations);
+    ESP_LOGI(TAG, "cycles/iteration : mean %lu min %lu max %lu",
+             (unsigned long)mean, (unsigned long)r->cycles_min, (unsigned long)r->cycles_max);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Interpreter benchmark for the controller container. Runs the container's
+// control law against bench natives: host_get_temperature replays a
+// synthetic triangle wave that crosses the hysteresis band. Step-ABI
+// containers get one timed step() call per iteration; legacy main()-loop
+// containers close an iteration on every host_delay() call, which returns
+// without sleeping. Either way the numbers are pure control-law + native-call
+// cost.
+//
+// Built into the firmware with CONFIG_CONTROLLER_INTERP_BENCH and on Linux as
+// host/bench/interp_bench; run it once per interpreter mode and compare.
+
+typedef struct {
+    const char *mode;           // "classic" or "fast"
+    uint32_t image_size;        // Bytecode size in bytes
+    size_t load_bytes;          // Heap taken by wasm_runtime_load
+    size_t instantiate_bytes;   // Heap taken by instantiate + exec env
+    uint32_t iterations;        // Control iterations measured
+    uint32_t cycles_min;
+    uint32_t cycles_max;
+    uint64_t cycles_total;
+} interp_bench_result_t;
+
+// Register the bench natives under "env". Call once after runtime init,
+// instead of the control natives.
+bool interp_bench_register_natives(void);
+
+// Load, instantiate and run the image for `iterations` control periods.
+// The image is not modified by the fast interpreter; the classic interpreter
+// patches it while loading, so pass a fresh copy for each run.
+bool interp_bench_run(uint8_t *image, uint32_t size, uint32_t iterations,
+                      interp_bench_result_t *result);
+
+void interp_bench_report(const interp_bench_result_t *result);
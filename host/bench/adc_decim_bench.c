@@ -0,0 +1,119 @@
+// Decimation kernel (adc_decimator.c) fed with synthetic ADC blocks: a slow
+// ramp plus a sine plus uniform noise, cut into DMA-like blocks of random
+// size that straddle window boundaries. Every window is checked against a
+// straightforward reference over the same samples, then the kernel is timed.
+// Exits non-zero on any mismatch.
+//
+//   adc_decim_bench [factor] [windows]
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "adc_decimator.h"
+#include "esp_timer.h"
+
+#define MAX_BLOCK 1024 // Largest synthetic DMA block (samples)
+
+static uint16_t synth(uint32_t i)
+{
+    double v = 1500.0 + i * 0.001 + 200.0 * sin(i * 0.01) + (rand() % 64) - 32;
+    if (v < 0.0)
+        v = 0.0;
+    if (v > 4095.0)
+        v = 4095.0;
+    return (uint16_t)v;
+}
+
+static bool close_enough(double got, double want, double tolerance)
+{
+    return fabs(got - want) <= tolerance * (1.0 + fabs(want));
+}
+
+// Reference reduction of one window
+static bool check_window(const uint16_t *s, uint32_t n, const adc_window_t *w)
+{
+    double sum = 0.0;
+    uint16_t lo = s[0], hi = s[0];
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sum += s[i];
+        lo = s[i] < lo ? s[i] : lo;
+        hi = s[i] > hi ? s[i] : hi;
+    }
+    double mean = sum / n;
+    double var = 0.0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        var += (s[i] - mean) * (s[i] - mean);
+    }
+    var /= n;
+
+    return w->min == lo && w->max == hi && close_enough(w->mean, mean, 1e-6) &&
+           close_enough(w->variance, var, 1e-4);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t factor = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 200;
+    uint32_t windows = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 20000;
+    if (factor < 1 || factor > ADC_DECIMATOR_MAX_FACTOR || windows < 1)
+    {
+        fprintf(stderr, "factor must be 1..%d, windows positive\n", ADC_DECIMATOR_MAX_FACTOR);
+        return 1;
+    }
+
+    uint32_t total = factor * windows;
+    uint16_t *samples = malloc(total * sizeof(uint16_t));
+    adc_window_t *out = malloc((windows + 1) * sizeof(adc_window_t));
+    if (!samples || !out)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < total; i++)
+    {
+        samples[i] = synth(i);
+    }
+
+    // Correctness: random block sizes, including empty ones
+    adc_decimator_t d;
+    adc_decimator_init(&d, factor);
+    uint32_t got = 0;
+    for (uint32_t pos = 0; pos < total;)
+    {
+        uint32_t block = (uint32_t)rand() % (MAX_BLOCK + 1);
+        if (block > total - pos)
+            block = total - pos;
+        got += adc_decimator_feed(&d, samples + pos, block, out + got, windows + 1 - got);
+        pos += block;
+    }
+
+    uint32_t bad = 0;
+    for (uint32_t w = 0; w < got; w++)
+    {
+        if (!check_window(samples + (size_t)w * factor, factor, &out[w]))
+        {
+            if (bad++ < 5)
+                fprintf(stderr, "window %u: mean %.3f var %.3f min %u max %u\n", w,
+                        out[w].mean, out[w].variance, out[w].min, out[w].max);
+        }
+    }
+    printf("factor %u: %u/%u windows, %u mismatched\n", factor, got, windows, bad);
+
+    // Throughput: DMA-frame-sized blocks
+    const uint32_t block = 512;
+    int64_t start = esp_timer_get_time();
+    adc_decimator_init(&d, factor);
+    for (uint32_t pos = 0; pos + block <= total; pos += block)
+    {
+        adc_decimator_feed(&d, samples + pos, block, out, windows + 1);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    printf("%.2f ns/sample (%.1f Msamples/s)\n", elapsed_us * 1000.0 / total,
+           elapsed_us ? total / (double)elapsed_us : 0.0);
+
+    free(samples);
+    free(out);
+    return (bad == 0 && got == windows) ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+// Block kernels of the signal filter library (signal_filter.c): float vs
+// Q15 vs Q31 cost per sample for each filter, on a noisy sine with spikes,
+// and the fixed-point error against the float output (in Q15 LSBs, 1/32768
+// of full scale). Build with -DCMAKE_C_FLAGS=-fno-tree-vectorize to see what
+// the chunked feed-forward loops buy.
+//
+//   filter_bench [samples] [block]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "signal_filter.h"
+#include "esp_timer.h"
+
+#define MA_LEN     16
+#define EMA_ALPHA  0.05f
+#define FC_HZ      2.0f
+#define FS_HZ      100.0f
+#define MEDIAN_LEN 5
+
+typedef void (*kernel_fn)(void *state, const void *in, void *out, uint32_t n);
+
+#define WRAP(fn, state_t, sample_t)                                        \
+    static void run_##fn(void *s, const void *in, void *out, uint32_t n)   \
+    {                                                                      \
+        fn((state_t *)s, (const sample_t *)in, (sample_t *)out, n);        \
+    }
+
+WRAP(sf_ma_f32, sf_ma_f32_t, float)
+WRAP(sf_ema_f32, sf_ema_f32_t, float)
+WRAP(sf_biquad_f32, sf_biquad_f32_t, float)
+WRAP(sf_median_f32, sf_median_f32_t, float)
+WRAP(sf_ma_q15, sf_ma_q15_t, int16_t)
+WRAP(sf_ema_q15, sf_ema_q15_t, int16_t)
+WRAP(sf_biquad_q15, sf_biquad_q15_t, int16_t)
+WRAP(sf_median_q15, sf_median_q15_t, int16_t)
+WRAP(sf_ma_q31, sf_ma_q31_t, int32_t)
+WRAP(sf_ema_q31, sf_ema_q31_t, int32_t)
+WRAP(sf_biquad_q31, sf_biquad_q31_t, int32_t)
+WRAP(sf_median_q31, sf_median_q31_t, int32_t)
+
+static union {
+    sf_ma_f32_t ma_f32;
+    sf_ema_f32_t ema_f32;
+    sf_biquad_f32_t biquad_f32;
+    sf_median_f32_t median_f32;
+    sf_ma_q15_t ma_q15;
+    sf_ema_q15_t ema_q15;
+    sf_biquad_q15_t biquad_q15;
+    sf_median_q15_t median_q15;
+    sf_ma_q31_t ma_q31;
+    sf_ema_q31_t ema_q31;
+    sf_biquad_q31_t biquad_q31;
+    sf_median_q31_t median_q31;
+} state;
+
+static float coeffs[SF_BIQUAD_COEFFS];
+
+static void init_state(int filter, int format)
+{
+    switch (filter * 3 + format)
+    {
+    case 0: sf_ma_f32_init(&state.ma_f32, MA_LEN, 0.0f); break;
+    case 1: sf_ma_q15_init(&state.ma_q15, MA_LEN, 0); break;
+    case 2: sf_ma_q31_init(&state.ma_q31, MA_LEN, 0); break;
+    case 3: sf_ema_f32_init(&state.ema_f32, EMA_ALPHA, 0.0f); break;
+    case 4: sf_ema_q15_init(&state.ema_q15, EMA_ALPHA, 0); break;
+    case 5: sf_ema_q31_init(&state.ema_q31, EMA_ALPHA, 0); break;
+    case 6: sf_biquad_f32_init(&state.biquad_f32, coeffs, 0.0f); break;
+    case 7: sf_biquad_q15_init(&state.biquad_q15, coeffs, 0); break;
+    case 8: sf_biquad_q31_init(&state.biquad_q31, coeffs, 0); break;
+    case 9: sf_median_f32_init(&state.median_f32, MEDIAN_LEN, 0.0f); break;
+    case 10: sf_median_q15_init(&state.median_q15, MEDIAN_LEN, 0); break;
+    case 11: sf_median_q31_init(&state.median_q31, MEDIAN_LEN, 0); break;
+    }
+}
+
+static const char *filter_names[] = {"moving avg", "ema", "biquad lp", "median"};
+static const char *format_names[] = {"float", "q15", "q31"};
+static const size_t sample_size[] = {sizeof(float), sizeof(int16_t), sizeof(int32_t)};
+static const kernel_fn kernels[4][3] = {
+    {run_sf_ma_f32, run_sf_ma_q15, run_sf_ma_q31},
+    {run_sf_ema_f32, run_sf_ema_q15, run_sf_ema_q31},
+    {run_sf_biquad_f32, run_sf_biquad_q15, run_sf_biquad_q31},
+    {run_sf_median_f32, run_sf_median_q15, run_sf_median_q31},
+};
+
+// Output sample i as a fraction of full scale
+static double sample_at(int format, const void *buf, uint32_t i)
+{
+    switch (format)
+    {
+    case 0: return ((const float *)buf)[i];
+    case 1: return ((const int16_t *)buf)[i] / 32768.0;
+    default: return ((const int32_t *)buf)[i] / 2147483648.0;
+    }
+}
+
+static double ns_per_sample(int filter, int format, const void *in, void *out, uint32_t samples,
+                            uint32_t block)
+{
+    const size_t size = sample_size[format];
+    init_state(filter, format);
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t pos = 0; pos < samples; pos += block)
+    {
+        uint32_t n = samples - pos < block ? samples - pos : block;
+        kernels[filter][format](&state, (const char *)in + pos * size, (char *)out + pos * size, n);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    return elapsed_us * 1000.0 / samples;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t samples = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 1000000;
+    uint32_t block = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 64;
+    if (samples < 1 || block < 1)
+    {
+        fprintf(stderr, "samples and block must be positive\n");
+        return 1;
+    }
+
+    // Slow sine, uniform noise and a spike every 997 samples, within +/-0.9
+    float *in_f32 = malloc(samples * sizeof(float));
+    int16_t *in_q15 = malloc(samples * sizeof(int16_t));
+    int32_t *in_q31 = malloc(samples * sizeof(int32_t));
+    float *ref = malloc(samples * sizeof(float));
+    void *out = malloc(samples * sizeof(int32_t));
+    if (!in_f32 || !in_q15 || !in_q31 || !ref || !out)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        float x = 0.5f * sinf(i * 0.00314f) + ((rand() % 2001) - 1000) * 0.00005f;
+        if (i % 997 == 0)
+            x += 0.3f;
+        in_f32[i] = x;
+        in_q15[i] = (int16_t)lrintf(x * 32768.0f);
+        in_q31[i] = (int32_t)lrint(x * 2147483648.0);
+    }
+    const void *inputs[] = {in_f32, in_q15, in_q31};
+    sf_biquad_lowpass(coeffs, FC_HZ, FS_HZ, 0.7071f);
+
+    printf("%u samples in blocks of %u\n", samples, block);
+    printf("%10s | %6s | %10s | %14s\n", "filter", "format", "ns/sample", "max err (LSB)");
+    for (int filter = 0; filter < 4; filter++)
+    {
+        ns_per_sample(filter, 0, in_f32, ref, samples, block);
+        for (int format = 0; format < 3; format++)
+        {
+            double ns = ns_per_sample(filter, format, inputs[format], out, samples, block);
+
+            double err = 0.0;
+            for (uint32_t i = 0; format > 0 && i < samples; i++)
+            {
+                double e = fabs(sample_at(format, out, i) - ref[i]);
+                err = e > err ? e : err;
+            }
+            if (format == 0)
+                printf("%10s | %6s | %10.2f | %14s\n", filter_names[filter],
+                       format_names[format], ns, "-");
+            else
+                printf("%10s | %6s | %10.2f | %14.2f\n", filter_names[filter],
+                       format_names[format], ns, err * 32768.0);
+        }
+    }
+
+    free(in_f32);
+    free(in_q15);
+    free(in_q31);
+    free(ref);
+    free(out);
+    return 0;
+}
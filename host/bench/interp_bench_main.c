@@ -0,0 +1,71 @@
+// Linux driver for the controller interpreter benchmark (interp_bench.c).
+//
+//   interp_bench [container.wasm] [iterations]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "interp_bench.h"
+#include "esp_log.h"
+#include "wasm_export.h"
+
+#define TAG "BENCH"
+#define DEFAULT_CONTAINER "controller/wasm_assets/controller.wasm"
+#define DEFAULT_ITERATIONS 100000
+
+static uint8_t *read_file(const char *path, uint32_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        ESP_LOGE(TAG, "Failed to open %s", path);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long fsize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *buffer = malloc(fsize);
+    if (buffer && fread(buffer, 1, fsize, f) != (size_t)fsize)
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+    fclose(f);
+    *size = (uint32_t)fsize;
+    return buffer;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : DEFAULT_CONTAINER;
+    uint32_t iterations = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : DEFAULT_ITERATIONS;
+
+    RuntimeInitArgs init_args;
+    memset(&init_args, 0, sizeof(RuntimeInitArgs));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args))
+    {
+        ESP_LOGE(TAG, "WAMR Init Failed");
+        return 1;
+    }
+    interp_bench_register_natives();
+
+    uint32_t size = 0;
+    uint8_t *image = read_file(path, &size);
+    if (!image)
+    {
+        return 1;
+    }
+
+    interp_bench_result_t result;
+    bool ok = interp_bench_run(image, size, iterations, &result);
+    if (ok)
+    {
+        interp_bench_report(&result);
+    }
+
+    free(image);
+    wasm_runtime_destroy();
+    return ok ? 0 : 1;
+}
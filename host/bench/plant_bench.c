@@ -0,0 +1,141 @@
+// Throughput of the batched plant engine (plant_bank.c): cost per plant-tick
+// of the physics loop alone and of a full tick with sensor noise, for a range
+// of bank sizes. Build with and without -DCMAKE_C_FLAGS=-fno-tree-vectorize
+// to see what the structure-of-arrays layout buys.
+//
+// Then, for every plug-in model (plant_model.c): cost per step with each
+// integrator, and the worst temperature error over a heat-up/cool-down run
+// against an RK4 reference at a 10x finer step, for a range of step sizes.
+//
+//   plant_bench [ticks]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "plant_bank.h"
+#include "plant_model.h"
+#include "esp_timer.h"
+
+#define ACCURACY_RUN_S 200.0f // Heater on for the first half, off for the second
+#define REFERENCE_DIV  10
+
+static plant_bank_t bank;
+
+static double ns_per_plant_tick(uint32_t plants, uint32_t ticks, void (*step)(plant_bank_t *))
+{
+    plant_bank_init(&bank, plants);
+    for (uint32_t i = 0; i < plants; i++)
+    {
+        bank.heater[i] = (i & 1) ? 1.0f : 0.0f;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        step(&bank);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    // Keep the result live
+    volatile float sink = bank.temp[plants - 1];
+    (void)sink;
+    return elapsed_us * 1000.0 / ((double)plants * ticks);
+}
+
+static double ns_per_model_step(const plant_model_t *model, plant_integrator_t integrator,
+                                uint32_t ticks)
+{
+    plant_t plant;
+    plant_init(&plant, model, integrator);
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        plant_step(&plant, 0.05f, (t & 1024) ? 1.0f : 0.0f);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    volatile float sink = plant_temperature(&plant);
+    (void)sink;
+    return elapsed_us * 1000.0 / ticks;
+}
+
+static float heater_profile(float t)
+{
+    return t >= 0.0f && t < ACCURACY_RUN_S / 2 ? 1.0f : 0.0f;
+}
+
+// Worst |T - T_ref| over the run, sampled every dt. The reference sees the
+// dead time (if any) applied to the profile directly, not through its own
+// delay line, so the test plant's delay line is checked too.
+static float max_error(const plant_model_t *model, plant_integrator_t integrator, float dt)
+{
+    static plant_t plant, ref;
+    plant_init(&plant, model, integrator);
+    plant_init(&ref, model, PLANT_INTEGRATOR_RK4);
+    float delay = 0.0f;
+    if (model->delay_param >= 0)
+    {
+        delay = ref.p[model->delay_param];
+        ref.p[model->delay_param] = 0.0f;
+    }
+    uint32_t steps = (uint32_t)(ACCURACY_RUN_S / dt);
+    float worst = 0.0f;
+
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        plant_step(&plant, dt, heater_profile(i * dt));
+        float u_ref = heater_profile(i * dt - delay);
+        for (uint32_t j = 0; j < REFERENCE_DIV; j++)
+        {
+            plant_step(&ref, dt / REFERENCE_DIV, u_ref);
+        }
+        float err = fabsf(plant_temperature(&plant) - plant_temperature(&ref));
+        if (err > worst)
+            worst = err;
+    }
+    return worst;
+}
+
+static void model_report(uint32_t ticks)
+{
+    const float steps[] = {0.05f, 0.25f, 1.0f, 2.5f};
+
+    printf("\n%14s | %10s %10s | %8s | %s\n", "model", "euler ns", "rk4 ns", "dt (s)",
+           "max error euler / rk4 (C)");
+    for (uint32_t m = 0; plant_model_at(m); m++)
+    {
+        const plant_model_t *model = plant_model_at(m);
+        double euler_ns = ns_per_model_step(model, PLANT_INTEGRATOR_EULER, ticks);
+        double rk4_ns = ns_per_model_step(model, PLANT_INTEGRATOR_RK4, ticks);
+
+        for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+        {
+            float euler_err = max_error(model, PLANT_INTEGRATOR_EULER, steps[i]);
+            float rk4_err = max_error(model, PLANT_INTEGRATOR_RK4, steps[i]);
+            if (i == 0)
+                printf("%14s | %10.1f %10.1f | %8.2f | %10.3g / %10.3g\n", model->name, euler_ns,
+                       rk4_ns, steps[i], euler_err, rk4_err);
+            else
+                printf("%14s | %10s %10s | %8.2f | %10.3g / %10.3g\n", "", "", "", steps[i],
+                       euler_err, rk4_err);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t ticks = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000;
+    const uint32_t sizes[] = {1, 4, 16, PLANT_BANK_MAX};
+
+    printf("%u ticks per run\n", ticks);
+    printf("%7s | %16s | %16s\n", "plants", "integrate ns/pt", "step ns/pt");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        double integrate = ns_per_plant_tick(sizes[i], ticks, plant_bank_integrate);
+        double step = ns_per_plant_tick(sizes[i], ticks, plant_bank_step);
+        printf("%7u | %16.2f | %16.2f\n", sizes[i], integrate, step);
+    }
+
+    model_report(ticks);
+    return 0;
+}
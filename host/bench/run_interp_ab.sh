@@ -0,0 +1,35 @@
+#!/bin/bash
+# A/B benchmark of the WAMR classic vs fast interpreter on Linux.
+# Builds the host benchmark twice (one WAMR build per interpreter mode), runs
+# the same controller container through both and prints the per-iteration
+# cycles, heap use and the runtime code-size difference.
+#
+#   host/bench/run_interp_ab.sh [container.wasm] [iterations]
+#
+# On the ESP32, build the controller with sdkconfig.bench.classic or
+# sdkconfig.bench.fast appended to SDKCONFIG_DEFAULTS (see those files) and
+# read the BENCH lines from the monitor; `idf.py size-components` gives the
+# code size of libespressif__wasm-micro-runtime.a for each mode.
+
+REPO_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+CONTAINER="${1:-$REPO_DIR/controller/wasm_assets/controller.wasm}"
+ITERATIONS="${2:-100000}"
+BUILD_ROOT="${BUILD_ROOT:-$REPO_DIR/build_host_bench}"
+
+for mode in classic fast; do
+    fast=0
+    [ "$mode" = "fast" ] && fast=1
+    cmake -S "$REPO_DIR/host" -B "$BUILD_ROOT/$mode" -DWAMR_BUILD_FAST_INTERP=$fast >/dev/null 2>&1 \
+        || { echo "Configuring $mode build failed"; exit 1; }
+    cmake --build "$BUILD_ROOT/$mode" --target interp_bench -j"$(nproc)" >/dev/null || exit 1
+done
+
+for mode in classic fast; do
+    echo "=== $mode"
+    "$BUILD_ROOT/$mode/interp_bench" "$CONTAINER" "$ITERATIONS" || exit 1
+done
+
+echo "=== runtime code size (text bytes)"
+for mode in classic fast; do
+    printf "%-8s %s\n" "$mode" "$(size -A "$BUILD_ROOT/$mode/libvmlib.a" | awk '$1 ~ /^\.text/ {s += $2} END {print s}')"
+done
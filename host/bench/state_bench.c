@@ -0,0 +1,158 @@
+// Contention benchmark for the lock-free sensor/actuator channel (sim_state.h)
+// against the mutex-protected variable it replaces.
+//
+// One writer thread publishes as fast as it can while N reader threads read;
+// every sample is checked for tearing (value, seq and timestamp must come
+// from the same publish). Reports throughput and the worst single read.
+//
+//   state_bench [readers] [seconds]
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim_state.h"
+#include "cycle_counter.h"
+
+#define MAX_READERS 16
+
+typedef struct {
+    uint64_t reads;
+    uint64_t torn;
+    uint32_t worst_cycles;
+} reader_stats_t;
+
+static atomic_bool running;
+static uint64_t writes;
+
+// Lock-free channel
+static sim_channel_t channel;
+
+// Mutex baseline: what the firmware did before
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static sim_sample_t locked_sample;
+
+static float value_for(uint32_t seq)
+{
+    return (float)(seq & 0xFFFFF);
+}
+
+static bool is_consistent(const sim_sample_t *s)
+{
+    return s->timestamp_us == (int64_t)s->seq && s->value == value_for(s->seq);
+}
+
+static void *lockfree_writer(void *arg)
+{
+    uint32_t seq = 0;
+    while (atomic_load_explicit(&running, memory_order_relaxed))
+    {
+        seq++;
+        sim_channel_publish(&channel, value_for(seq), seq);
+    }
+    writes = seq;
+    return NULL;
+}
+
+static void *lockfree_reader(void *arg)
+{
+    reader_stats_t *stats = arg;
+    while (atomic_load_explicit(&running, memory_order_relaxed))
+    {
+        uint32_t start = cycle_count();
+        sim_sample_t s = sim_channel_read(&channel);
+        uint32_t cycles = cycle_count() - start;
+
+        if (cycles > stats->worst_cycles)
+            stats->worst_cycles = cycles;
+        if (!is_consistent(&s))
+            stats->torn++;
+        stats->reads++;
+    }
+    return NULL;
+}
+
+static void *mutex_writer(void *arg)
+{
+    uint32_t seq = 0;
+    while (atomic_load_explicit(&running, memory_order_relaxed))
+    {
+        seq++;
+        pthread_mutex_lock(&mutex);
+        locked_sample.value = value_for(seq);
+        locked_sample.seq = seq;
+        locked_sample.timestamp_us = seq;
+        pthread_mutex_unlock(&mutex);
+    }
+    writes = seq;
+    return NULL;
+}
+
+static void *mutex_reader(void *arg)
+{
+    reader_stats_t *stats = arg;
+    while (atomic_load_explicit(&running, memory_order_relaxed))
+    {
+        uint32_t start = cycle_count();
+        pthread_mutex_lock(&mutex);
+        sim_sample_t s = locked_sample;
+        pthread_mutex_unlock(&mutex);
+        uint32_t cycles = cycle_count() - start;
+
+        if (cycles > stats->worst_cycles)
+            stats->worst_cycles = cycles;
+        if (!is_consistent(&s))
+            stats->torn++;
+        stats->reads++;
+    }
+    return NULL;
+}
+
+static void run(const char *name, void *(*writer)(void *), void *(*reader)(void *),
+                int readers, double seconds)
+{
+    pthread_t writer_thread;
+    pthread_t reader_threads[MAX_READERS];
+    reader_stats_t stats[MAX_READERS] = {0};
+
+    atomic_store(&running, true);
+    for (int i = 0; i < readers; i++)
+        pthread_create(&reader_threads[i], NULL, reader, &stats[i]);
+    pthread_create(&writer_thread, NULL, writer, NULL);
+
+    struct timespec ts = {(time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9)};
+    nanosleep(&ts, NULL);
+    atomic_store(&running, false);
+
+    pthread_join(writer_thread, NULL);
+    uint64_t reads = 0, torn = 0;
+    uint32_t worst = 0;
+    for (int i = 0; i < readers; i++)
+    {
+        pthread_join(reader_threads[i], NULL);
+        reads += stats[i].reads;
+        torn += stats[i].torn;
+        if (stats[i].worst_cycles > worst)
+            worst = stats[i].worst_cycles;
+    }
+
+    printf("%-9s writes %10.0f/s | reads %11.0f/s | torn %llu | worst read %lu cycles\n",
+           name, writes / seconds, reads / seconds, (unsigned long long)torn, (unsigned long)worst);
+}
+
+int main(int argc, char **argv)
+{
+    int readers = argc > 1 ? atoi(argv[1]) : 3;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+    if (readers < 1 || readers > MAX_READERS)
+    {
+        fprintf(stderr, "readers must be 1..%d\n", MAX_READERS);
+        return 1;
+    }
+
+    printf("1 writer, %d readers, %.1f s per run\n", readers, seconds);
+    sim_channel_init(&channel, 0.0f);
+    run("lock-free", lockfree_writer, lockfree_reader, readers, seconds);
+    run("mutex", mutex_writer, mutex_reader, readers, seconds);
+    return 0;
+}
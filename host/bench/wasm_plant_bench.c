@@ -0,0 +1,137 @@
+// Cost of WASM plant containers (bridge/main/wasm_plant.c) against the
+// native plant models (plant_model.c): time per plant-step for banks of N
+// instances stepped back to back like a bridge tick, and how many plants
+// that sustains at common tick rates when the simulation may use half of
+// one core.
+//
+//   wasm_plant_bench plant.wasm [ticks]
+//
+// Build with -DWAMR_BUILD_FAST_INTERP=0 for the classic interpreter. On the
+// ESP32 the per-step cost grows with the interpreter / AOT ratio measured by
+// interp_bench, so scale the plant counts accordingly.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "plant_model.h"
+#include "wasm_plant.h"
+#include "esp_timer.h"
+
+#define DT_S       0.05f
+#define CPU_BUDGET 0.5 // Share of one core the plant tick may use
+
+static const uint32_t sizes[] = {1, 4, 16, 64, 256};
+static const uint32_t rates_hz[] = {20, 100, 1000};
+
+// Square-wave heater command, so the plants do not settle
+static float heater(uint32_t tick, uint32_t plant)
+{
+    return ((tick + plant * 16) & 256) ? 1.0f : 0.0f;
+}
+
+static double wasm_ns_per_step(wasm_module_t module, uint32_t n, uint32_t ticks)
+{
+    wasm_plant_t *plants = wasm_plant_create_array(module, "bench", n);
+    if (!plants)
+        return -1.0;
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            wasm_plant_step(&plants[i], DT_S, heater(t, i));
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    uint32_t traps = 0;
+    for (uint32_t i = 0; i < n; i++)
+        traps += plants[i].traps;
+    if (traps)
+        printf("  %u trapped steps\n", traps);
+
+    wasm_plant_destroy_array(plants, n);
+    return elapsed_us * 1000.0 / ((double)n * ticks);
+}
+
+static double native_ns_per_step(const plant_model_t *model, plant_integrator_t integrator,
+                                 uint32_t n, uint32_t ticks)
+{
+    plant_t *plants = malloc(n * sizeof(plant_t));
+    for (uint32_t i = 0; i < n; i++)
+        plant_init(&plants[i], model, integrator);
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            plant_step(&plants[i], DT_S, heater(t, i));
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    volatile float sink = plant_temperature(&plants[n - 1]);
+    (void)sink;
+    free(plants);
+    return elapsed_us * 1000.0 / ((double)n * ticks);
+}
+
+static void print_row(const char *label, uint32_t n, double ns)
+{
+    printf("%-22s %6u | %10.1f |", label, n, ns);
+    for (size_t r = 0; r < sizeof(rates_hz) / sizeof(rates_hz[0]); r++)
+    {
+        double budget_ns = CPU_BUDGET * 1e9 / rates_hz[r];
+        printf(" %12.0f", ns > 0.0 ? budget_ns / ns : 0.0);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s plant.wasm [ticks]\n", argv[0]);
+        return 1;
+    }
+    uint32_t ticks = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 20000;
+
+    RuntimeInitArgs init_args;
+    memset(&init_args, 0, sizeof(RuntimeInitArgs));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args) || !wasm_plant_register_natives())
+    {
+        fprintf(stderr, "WAMR init failed\n");
+        return 1;
+    }
+
+    uint8_t *buffer = NULL;
+    wasm_module_t module = wasm_plant_load(argv[1], &buffer);
+    if (!module)
+        return 1;
+
+    printf("%u ticks per run, plants sustained with %.0f%% of one core\n", ticks,
+           CPU_BUDGET * 100.0);
+    printf("%-22s %6s | %10s | %9s Hz %9s Hz %9s Hz\n", "plant", "N", "ns/step",
+           "20", "100", "1000");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        print_row("wasm", sizes[i], wasm_ns_per_step(module, sizes[i], ticks));
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        print_row("native first_order", sizes[i],
+                  native_ns_per_step(&plant_model_first_order, PLANT_INTEGRATOR_EULER, sizes[i], ticks));
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        print_row("native second_order", sizes[i],
+                  native_ns_per_step(&plant_model_second_order, PLANT_INTEGRATOR_RK4, sizes[i], ticks));
+    }
+
+    wasm_runtime_unload(module);
+    free(buffer);
+    wasm_runtime_destroy();
+    return 0;
+}
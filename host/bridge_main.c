@@ -0,0 +1,159 @@
+// Linux build of the ESP-NOW bridge (bridge1.c): the same plant model and
+// frame handling (bridge_sim.c), talking UDP instead of ESP-NOW.
+//
+//   sim_bridge [-t tick_us] [-N plants] [-p local_port] [-c controller_host]
+//              [-P controller_port] [-n ticks] [-T trace_file]
+//              [-m model] [-i euler|rk4] [-w plant.wasm]
+//
+// -t 0 runs the plants as fast as the host allows. -m picks a plant model
+// from plant_model.h instead of the built-in one; -w runs every plant as an
+// instance of a WASM plant container (wasm_plant.h) instead. -T drains the binary
+// trace (sim_trace.h) to a file ("-" for stdout) for common/trace_decode.py.
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bridge_sim.h"
+#include "sim_transport.h"
+#include "sim_trace.h"
+#include "wasm_plant.h"
+#include "esp_log.h"
+
+#define TAG "BRIDGE"
+#define STATUS_PERIOD_US 1000000
+#define TRACE_DRAIN_MS 250
+
+static void sleep_until(struct timespec *next, uint32_t period_us)
+{
+    next->tv_nsec += (long)period_us * 1000;
+    while (next->tv_nsec >= 1000000000L)
+    {
+        next->tv_nsec -= 1000000000L;
+        next->tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, next, NULL);
+}
+
+// Load a plant container and run every plant as one of its instances
+static bool start_wasm_plants(const char *path, uint32_t count)
+{
+    RuntimeInitArgs init_args;
+    memset(&init_args, 0, sizeof(RuntimeInitArgs));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args) || !wasm_plant_register_natives())
+    {
+        ESP_LOGE(TAG, "WAMR Init Failed");
+        return false;
+    }
+
+    uint8_t *buffer = NULL;
+    wasm_module_t module = wasm_plant_load(path, &buffer);
+    wasm_plant_t *plants = module ? wasm_plant_create_array(module, path, count) : NULL;
+    if (!plants)
+    {
+        return false;
+    }
+    bridge_sim_set_external(wasm_plant_external_step, plants);
+    ESP_LOGI(TAG, "Plant model: %s, %lu WASM instance(s)", path, (unsigned long)count);
+    return true; // Instances live as long as the process
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t tick_us = BRIDGE_SIM_TICK_MS * 1000;
+    uint16_t local_port = SIM_BRIDGE_UDP_PORT;
+    const char *peer_host = "127.0.0.1";
+    uint16_t peer_port = SIM_CONTROLLER_UDP_PORT;
+    uint64_t max_ticks = 0;
+    uint32_t plant_count = 1;
+    const char *trace_path = NULL;
+    const char *model = NULL;
+    const char *integrator_name = "rk4";
+    const char *wasm_path = NULL;
+    plant_integrator_t integrator;
+    int opt;
+
+    setvbuf(stdout, NULL, _IOLBF, 0); // Keep logs line-ordered when piped
+
+    while ((opt = getopt(argc, argv, "t:N:p:c:P:n:T:m:i:w:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't': tick_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'N': plant_count = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'p': local_port = (uint16_t)atoi(optarg); break;
+        case 'c': peer_host = optarg; break;
+        case 'P': peer_port = (uint16_t)atoi(optarg); break;
+        case 'n': max_ticks = strtoull(optarg, NULL, 0); break;
+        case 'T': trace_path = optarg; break;
+        case 'm': model = optarg; break;
+        case 'i': integrator_name = optarg; break;
+        case 'w': wasm_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-t tick_us] [-N plants] [-p local_port] "
+                            "[-c controller_host] [-P controller_port] [-n ticks] [-T trace_file] "
+                            "[-m model] [-i euler|rk4] [-w plant.wasm]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (plant_count < 1 || plant_count > PLANT_BANK_MAX)
+    {
+        fprintf(stderr, "plants must be 1..%d\n", PLANT_BANK_MAX);
+        return 1;
+    }
+    if (!plant_integrator_parse(integrator_name, &integrator))
+    {
+        fprintf(stderr, "integrator must be euler or rk4\n");
+        return 1;
+    }
+    bridge_sim_init(plant_count);
+    if (model && !bridge_sim_set_model(model, integrator))
+    {
+        return 1;
+    }
+    if (wasm_path && !start_wasm_plants(wasm_path, plant_count))
+    {
+        return 1;
+    }
+    if (trace_path)
+    {
+        FILE *trace = strcmp(trace_path, "-") == 0 ? stdout : fopen(trace_path, "w");
+        if (!trace)
+        {
+            perror(trace_path);
+            return 1;
+        }
+        sim_trace_start_drain(trace, TRACE_DRAIN_MS);
+    }
+    if (!sim_transport_udp_init(local_port, peer_host, peer_port, bridge_sim_on_receive))
+    {
+        return 1;
+    }
+
+    ESP_LOGI(TAG, "Bridge started - %lu plant(s), tick %lu us",
+             (unsigned long)plant_count, (unsigned long)tick_us);
+    ESP_LOGI(TAG, "Ambient: %.1fC, Heating Rate: %.2f, Cooling Rate: %.2f",
+             AMBIENT_TEMP, HEATING_RATE, COOLING_RATE);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint32_t status_every = tick_us ? STATUS_PERIOD_US / tick_us : 0;
+    for (uint64_t tick = 1; max_ticks == 0 || tick <= max_ticks; tick++)
+    {
+        bridge_sim_tick();
+
+        if (status_every && tick % status_every == 0)
+        {
+            ESP_LOGI(TAG, "tick %llu | plant 0 temp %.2f C | heater %.0f%%",
+                     (unsigned long long)tick, bridge_sim_temperature(0),
+                     bridge_sim_heater(0) * 100.0f);
+        }
+        if (tick_us)
+        {
+            sleep_until(&next, tick_us);
+        }
+    }
+    return 0;
+}
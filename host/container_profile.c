@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include "container_profile.h"
+#include "esp_log.h"
+
+#if WASM_ENABLE_MEMORY_PROFILING != 0
+#include "wasm_exec_env.h"
+#include "wasm_runtime.h"
+
+// Not exported by WAMR; wasm_runtime_dump_mem_consumption() uses it the same way
+uint32_t gc_get_heap_highmark_size(void *heap);
+#endif
+
+#define TAG "PROFILE"
+
+// Margins: half again the peak, rounded up; the native stack gets twice the
+// peak plus room for logging and the executor, the host frames being no
+// guide to Xtensa ones
+#define WASM_STACK_ALIGN   256
+#define APP_HEAP_MIN       256 // WAMR refuses smaller app heaps
+#define APP_HEAP_ALIGN     256
+#define NATIVE_STACK_SLACK (8 * 1024)
+#define NATIVE_STACK_ALIGN 1024
+
+static uint8_t *native_base = NULL;
+
+static uint32_t round_up(uint32_t value, uint32_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+bool container_profile_supported(void)
+{
+#if WASM_ENABLE_MEMORY_PROFILING != 0
+    return true;
+#else
+    return false;
+#endif
+}
+
+void container_profile_begin(wasm_exec_env_t exec_env)
+{
+    (void)exec_env;
+    native_base = __builtin_frame_address(0);
+}
+
+void container_profile_read(wasm_exec_env_t exec_env, container_profile_t *profile)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    wasm_memory_inst_t memory = wasm_runtime_get_default_memory(module_inst);
+
+    profile->memory_pages = memory ? (uint32_t)wasm_memory_get_cur_page_count(memory) : 0;
+    profile->page_bytes = memory ? (uint32_t)wasm_memory_get_bytes_per_page(memory) : 0;
+    profile->wasm_stack = 0;
+    profile->app_heap = 0;
+    profile->native_stack = 0;
+
+#if WASM_ENABLE_MEMORY_PROFILING != 0
+    WASMExecEnv *env = (WASMExecEnv *)exec_env;
+    profile->wasm_stack = env->max_wasm_stack_used;
+    if (native_base && env->native_stack_top_min != (uint8_t *)UINTPTR_MAX
+        && env->native_stack_top_min < native_base)
+    {
+        profile->native_stack = (uint32_t)(native_base - env->native_stack_top_min);
+    }
+    if (memory && ((WASMMemoryInstance *)memory)->heap_handle)
+    {
+        profile->app_heap = gc_get_heap_highmark_size(((WASMMemoryInstance *)memory)->heap_handle);
+    }
+#endif
+}
+
+void container_profile_budget(const container_profile_t *profile, container_budget_t *budget)
+{
+    budget->wasm_stack = round_up(profile->wasm_stack + profile->wasm_stack / 2, WASM_STACK_ALIGN);
+    budget->app_heap = 0; // No heap when nothing was allocated
+    if (profile->app_heap)
+    {
+        budget->app_heap = round_up(profile->app_heap + profile->app_heap / 2, APP_HEAP_ALIGN);
+        if (budget->app_heap < APP_HEAP_MIN)
+            budget->app_heap = APP_HEAP_MIN;
+    }
+    budget->max_pages = profile->memory_pages;
+    budget->native_stack = round_up(2 * profile->native_stack + NATIVE_STACK_SLACK,
+                                    NATIVE_STACK_ALIGN);
+}
+
+void container_profile_log(const char *name, const container_profile_t *profile,
+                           const container_budget_t *budget)
+{
+    ESP_LOGI(TAG, "%s: peak wasm stack %lu B, app heap %lu B, native stack %lu B | "
+                  "linear memory %lu x %lu B",
+             name, (unsigned long)profile->wasm_stack, (unsigned long)profile->app_heap,
+             (unsigned long)profile->native_stack, (unsigned long)profile->memory_pages,
+             (unsigned long)profile->page_bytes);
+    ESP_LOGI(TAG, "%s: budget wasm_stack=%lu app_heap=%lu max_pages=%lu native_stack=%lu",
+             name, (unsigned long)budget->wasm_stack, (unsigned long)budget->app_heap,
+             (unsigned long)budget->max_pages, (unsigned long)budget->native_stack);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "container_budget.h"
+#include "wasm_export.h"
+
+// Memory profile of a container run on the host, turned into a tight budget
+// manifest (container_budget.h). Needs a runtime built with
+// -DWAMR_BUILD_MEMORY_PROFILING=1, which tracks the peaks this reads.
+//
+// Peaks depend on the execution engine: profile with the one the firmware
+// uses (WAMR_BUILD_FAST_INTERP matching the sdkconfig). The native stack is
+// measured with host frames, which are not the Xtensa ones, so the budget
+// keeps a generous margin on it.
+
+typedef struct {
+    uint32_t wasm_stack;   // Peak exec env WASM stack (bytes)
+    uint32_t app_heap;     // Peak app heap in use, block headers included
+    uint32_t native_stack; // Deepest native stack seen below the profiled frame
+    uint32_t memory_pages; // Linear memory at the end of the run
+    uint32_t page_bytes;   // Bytes per page (below 64 KB once shrunk)
+} container_profile_t;
+
+// False when the runtime was built without memory profiling
+bool container_profile_supported(void);
+
+// Mark the native stack depth usage is measured from. Call from the frame
+// that runs the container, before its first call into it.
+void container_profile_begin(wasm_exec_env_t exec_env);
+
+// Peaks so far of the instance behind `exec_env`
+void container_profile_read(wasm_exec_env_t exec_env, container_profile_t *profile);
+
+// Set the memory budgets of `budget` to cover `profile` with margins; the
+// step budgets are left as they are
+void container_profile_budget(const container_profile_t *profile, container_budget_t *budget);
+
+void container_profile_log(const char *name, const container_profile_t *profile,
+                           const container_budget_t *budget);
@@ -0,0 +1,201 @@
+// Linux build of the ESP-NOW controller (controller1.c): the same WAMR
+// control loop and natives (controller_link.c, control_executor.c), talking
+// UDP instead of ESP-NOW and loading containers from a directory.
+//
+//   sim_controller [-d container_dir] [-c container_store.bin] [-n name]
+//                  [-N instances] [-t period_us] [-s send_us] [-p local_port]
+//                  [-b bridge_host] [-P bridge_port] [-u update_poll_ms]
+//                  [-T trace_file]
+//
+// -c maps a container store image (containers/pack_containers.py) read-only,
+// as the firmware maps its partition; containers are loaded from it first.
+// -N runs that many instances of the container, instance i driving plant i
+// of the bridge (sim_bridge -N). Send SIGUSR1 to dump the latency histograms
+// (kill -USR1 <pid>); they are also dumped when the containers stop.
+//
+// Containers are hot-swapped when their file in the container directory
+// changes (checked every update_poll_ms, 0 = never), or on SIGHUP. -T drains
+// the binary trace (sim_trace.h) to a file ("-" for stdout).
+//
+// To compare periodic and on-sample stepping, run once with and once
+// without step_on_sample=1 in the container's .mem manifest and compare the
+// "rx->heater cmd" and "rx->tx" histograms.
+#include <getopt.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "container_loader.h"
+#include "container_manager.h"
+#include "container_store.h"
+#include "control_executor.h"
+#include "controller_link.h"
+#include "filter_natives.h"
+#include "sim_transport.h"
+#include "sim_trace.h"
+#include "latency_hist.h"
+#include "esp_log.h"
+#include "wasm_export.h"
+
+#define TAG "CONTROLLER"
+#define DEFAULT_CONTAINER_DIR "controller/wasm_assets"
+#define CONTROL_PERIOD_MS 100 // Same as the firmware
+#define TRACE_DRAIN_MS 1000
+
+static uint32_t send_us = CONTROLLER_LINK_SEND_MS * 1000;
+static volatile sig_atomic_t dump_requested = 0;
+static volatile sig_atomic_t reload_requested = 0;
+
+static void on_sigusr1(int sig)
+{
+    dump_requested = 1;
+}
+
+static void on_sighup(int sig)
+{
+    reload_requested = 1;
+}
+
+// Stands in for the firmware's sender_task
+static void *sender_thread(void *arg)
+{
+    while (1)
+    {
+        controller_link_wait_commands(send_us);
+        controller_link_send_actuators();
+        if (dump_requested)
+        {
+            dump_requested = 0;
+            latency_hist_dump_all();
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = DEFAULT_CONTAINER_DIR;
+    const char *store_path = NULL;
+    const char *name = "controller";
+    uint32_t instances = 1;
+    uint32_t period_us = CONTROL_PERIOD_MS * 1000;
+    uint16_t local_port = SIM_CONTROLLER_UDP_PORT;
+    const char *peer_host = "127.0.0.1";
+    uint16_t peer_port = SIM_BRIDGE_UDP_PORT;
+    uint32_t update_poll_ms = 1000;
+    const char *trace_path = NULL;
+    int opt;
+
+    setvbuf(stdout, NULL, _IOLBF, 0); // Keep logs line-ordered when piped
+
+    while ((opt = getopt(argc, argv, "d:c:n:N:t:s:p:b:P:u:T:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd': dir = optarg; break;
+        case 'c': store_path = optarg; break;
+        case 'n': name = optarg; break;
+        case 'N': instances = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 't': period_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': send_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'p': local_port = (uint16_t)atoi(optarg); break;
+        case 'b': peer_host = optarg; break;
+        case 'P': peer_port = (uint16_t)atoi(optarg); break;
+        case 'u': update_poll_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'T': trace_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-d container_dir] [-c container_store.bin] [-n name] "
+                            "[-N instances] "
+                            "[-t period_us] [-s send_us] [-p local_port] [-b bridge_host] "
+                            "[-P bridge_port] [-u update_poll_ms] [-T trace_file]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (period_us == 0 || send_us == 0)
+    {
+        fprintf(stderr, "period and send interval must be non-zero\n");
+        return 1;
+    }
+    if (instances < 1 || instances > CONTROLLER_LINK_MAX_PLANTS)
+    {
+        fprintf(stderr, "instances must be 1..%d\n", CONTROLLER_LINK_MAX_PLANTS);
+        return 1;
+    }
+
+    controller_link_init();
+    if (trace_path)
+    {
+        FILE *trace = strcmp(trace_path, "-") == 0 ? stdout : fopen(trace_path, "w");
+        if (!trace)
+        {
+            perror(trace_path);
+            return 1;
+        }
+        sim_trace_start_drain(trace, TRACE_DRAIN_MS);
+    }
+    if (!sim_transport_udp_init(local_port, peer_host, peer_port, controller_link_on_receive))
+    {
+        return 1;
+    }
+
+    RuntimeInitArgs init_args;
+    memset(&init_args, 0, sizeof(RuntimeInitArgs));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args))
+    {
+        ESP_LOGE(TAG, "WAMR Init Failed");
+        return 1;
+    }
+    controller_link_register_natives();
+    filter_natives_register();
+
+    container_loader_set_dir(dir);
+    if (store_path && !container_store_open(store_path))
+    {
+        return 1;
+    }
+    container_manager_load_all();
+    if (!container_manager_module(name))
+    {
+        ESP_LOGE(TAG, "No container %s in %s", name, dir);
+        return 1;
+    }
+
+    signal(SIGUSR1, on_sigusr1);
+    signal(SIGHUP, on_sighup);
+    pthread_t t;
+    pthread_create(&t, NULL, sender_thread, NULL);
+
+    ESP_LOGI(TAG, "Controller Started - WASM Control Mode");
+    for (uint32_t plant = 0; plant < instances; plant++)
+    {
+        container_manager_spawn(name, period_us, CONTAINER_MANAGER_ANY_CORE,
+                                controller_link_bind(plant));
+    }
+
+    // Stands in for the firmware's update poll
+    uint32_t idle_ms = 0;
+    while (container_manager_running() > 0)
+    {
+        usleep(10 * 1000);
+        idle_ms += 10;
+        if (reload_requested)
+        {
+            reload_requested = 0;
+            container_manager_reload(name);
+        }
+        else if (update_poll_ms && idle_ms >= update_poll_ms)
+        {
+            idle_ms = 0;
+            container_manager_check_updates();
+        }
+    }
+    container_manager_join();
+    latency_hist_dump_all();
+
+    container_manager_unload_all();
+    wasm_runtime_destroy();
+    return 0;
+}
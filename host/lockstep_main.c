@@ -0,0 +1,439 @@
+// Faster-than-real-time lockstep run of the bridge plant (bridge_sim.c) and
+// a controller container in one process. A virtual clock replaces wall time:
+// the plant advances every BRIDGE_SIM_TICK_MS and the container every control
+// period of virtual time, back to back, with no sleeping and no transport.
+//
+// Step-ABI containers are stepped by the runner. Legacy main()-loop
+// containers work too: their host_delay(ms) advances virtual time by ms
+// instead of sleeping.
+//
+//   sim_lockstep [-d container_dir] [-c container_store.bin] [-n name]
+//                [-t period_ms] [-s sim_seconds] [-r report_seconds] [-S seed]
+//                [-m model] [-i euler|rk4] [-w plant.wasm] [-P]
+//
+// -c maps a container store image (containers/pack_containers.py) read-only,
+// as the firmware maps its partition, and loads the container from it first.
+// -m simulates a plant model from plant_model.h instead of the built-in one,
+// -w a WASM plant container (wasm_plant.h).
+//
+// The container runs within its budget manifest (<name>.mem, see
+// container_budget.h) when it has one. -P instead runs it with the default
+// budgets, records its peak stack, heap and memory use, and writes a tight
+// manifest to <container_dir>/<name>.mem; needs a host build with
+// -DWAMR_BUILD_MEMORY_PROFILING=1.
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bridge_sim.h"
+#include "container_budget.h"
+#include "container_loader.h"
+#include "container_profile.h"
+#include "container_store.h"
+#include "control_executor.h"
+#include "filter_natives.h"
+#include "heater_actuator.h"
+#include "wasm_plant.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "wasm_export.h"
+
+#define TAG "LOCKSTEP"
+#define DEFAULT_CONTAINER_DIR "controller/wasm_assets"
+#define DONE_EXCEPTION "lockstep done"
+
+// --- VIRTUAL CLOCK ---
+static uint64_t now_us = 0;
+static uint64_t end_us = 0;
+static uint64_t next_tick_us = 0;
+static const uint64_t tick_us = BRIDGE_SIM_TICK_MS * 1000;
+
+// --- PLANT STATE SEEN BY THE CONTROLLER ---
+static float last_reading = AMBIENT_TEMP;
+static float heater_cmd = 0.0f; // Applied duty, from the actuator mock backend
+
+// --- STATISTICS (per report window) ---
+static uint64_t report_us = 0;
+static uint64_t next_report_us = 0;
+static uint32_t window_ticks = 0;
+static double window_heater_sum = 0.0;
+static float window_min = 0.0f;
+static float window_max = 0.0f;
+static double window_sum = 0.0;
+
+static void report_window(void)
+{
+    if (window_ticks == 0)
+        return;
+    ESP_LOGI(TAG, "t=%8.1f s | temp mean %6.2f min %6.2f max %6.2f C | heater duty %3.0f%%",
+             now_us / 1e6, window_sum / window_ticks, window_min, window_max,
+             100.0 * window_heater_sum / window_ticks);
+    window_ticks = 0;
+    window_heater_sum = 0.0;
+    window_sum = 0.0;
+}
+
+// Run every plant tick due up to `target_us` of virtual time
+static void advance_to(uint64_t target_us)
+{
+    while (next_tick_us <= target_us)
+    {
+        now_us = next_tick_us;
+        bridge_sim_advance();
+        last_reading = bridge_sim_reading(0);
+        next_tick_us += tick_us;
+
+        float temp = bridge_sim_temperature(0);
+        if (window_ticks == 0 || temp < window_min)
+            window_min = temp;
+        if (window_ticks == 0 || temp > window_max)
+            window_max = temp;
+        window_sum += temp;
+        window_ticks++;
+        window_heater_sum += heater_cmd;
+
+        if (report_us && now_us >= next_report_us)
+        {
+            report_window();
+            next_report_us += report_us;
+        }
+    }
+    now_us = target_us;
+}
+
+// ============================================================================
+// LOCKSTEP NATIVES (same signatures as the control natives)
+// ============================================================================
+
+static float lockstep_get_temperature(wasm_exec_env_t exec_env)
+{
+    return last_reading;
+}
+
+// Commands go through the actuator (mock backend, same 13-bit duty as the
+// LEDC one), which hands the applied duty to the plant
+static void apply_heater_duty(float duty, void *arg)
+{
+    heater_cmd = duty;
+    bridge_sim_set_heater(0, duty);
+}
+
+static void lockstep_set_heater(wasm_exec_env_t exec_env, int value)
+{
+    heater_actuator_set_duty(value ? 1.0f : 0.0f);
+}
+
+static void lockstep_set_heater_duty(wasm_exec_env_t exec_env, float duty)
+{
+    heater_actuator_set_duty(duty);
+}
+
+// Legacy containers pace themselves with host_delay: advance virtual time
+// instead of sleeping, and stop the container once the run is over
+static void lockstep_delay(wasm_exec_env_t exec_env, int ms)
+{
+    advance_to(now_us + (uint64_t)ms * 1000);
+    if (now_us >= end_us)
+    {
+        wasm_runtime_set_exception(wasm_runtime_get_module_inst(exec_env), DONE_EXCEPTION);
+    }
+}
+
+static void lockstep_log(wasm_exec_env_t exec_env, const char *message)
+{
+    if (message)
+    {
+        ESP_LOGD("WASM", "%s", message);
+    }
+}
+
+// I/O window (see container_io.h): same channels as the natives above
+static void lockstep_io_fill(void *user_data, container_io_t *io)
+{
+    io->sensors[CONTAINER_IO_TEMPERATURE] = last_reading;
+    io->sensor_count = 1;
+}
+
+static void lockstep_io_drain(void *user_data, const container_io_t *io)
+{
+    if (io->actuator_dirty & (1u << CONTAINER_IO_HEATER))
+    {
+        heater_actuator_set_duty(io->actuators[CONTAINER_IO_HEATER]);
+    }
+}
+
+static const control_io_ops_t lockstep_io_ops = {
+    .fill = lockstep_io_fill,
+    .drain = lockstep_io_drain,
+};
+
+static NativeSymbol lockstep_symbols[] = {
+    {"host_get_temperature", lockstep_get_temperature, "()f", NULL},
+    {"host_set_heater", lockstep_set_heater, "(i)", NULL},
+    {"host_set_heater_duty", lockstep_set_heater_duty, "(f)", NULL},
+    {"host_delay", lockstep_delay, "(i)", NULL},
+    {"host_log", lockstep_log, "($)", NULL},
+};
+
+// ============================================================================
+// RUNNERS
+// ============================================================================
+
+static bool run_step_container(control_container_t *c)
+{
+    // On-sample containers (step_on_sample) step after every plant tick,
+    // each one being a new reading
+    const uint32_t interval_us = c->on_sample && tick_us < c->period_us ? tick_us : c->period_us;
+    const float dt = interval_us / 1e6f;
+    while (now_us < end_us)
+    {
+        if (!control_container_step(c, dt))
+        {
+            return false;
+        }
+        advance_to(now_us + interval_us);
+    }
+    control_container_report(c);
+    return true;
+}
+
+static bool run_main_container(wasm_module_inst_t module_inst, wasm_exec_env_t exec_env)
+{
+    wasm_function_inst_t func = wasm_runtime_lookup_function(module_inst, "main");
+    if (!func)
+    {
+        ESP_LOGE(TAG, "No step or main function found");
+        return false;
+    }
+
+    uint32_t args[2] = {0, 0}; // argc, argv
+    wasm_runtime_call_wasm(exec_env, func, 2, args);
+
+    const char *exception = wasm_runtime_get_exception(module_inst);
+    if (!exception || !strstr(exception, DONE_EXCEPTION))
+    {
+        ESP_LOGE(TAG, "Container stopped early: %s", exception ? exception : "returned");
+        return false;
+    }
+    return true;
+}
+
+// Run the container within `budget`. With `profile` set, its peak memory
+// use is stored there once the run is over.
+static bool run_lockstep(wasm_module_t module, const char *name, uint32_t period_us,
+                         const container_budget_t *budget, container_profile_t *profile)
+{
+    char error_buf[128];
+    bool ok = false;
+
+    wasm_module_inst_t module_inst = container_budget_instantiate(module, budget, error_buf,
+                                                                  sizeof(error_buf));
+    if (!module_inst)
+    {
+        ESP_LOGE(TAG, "WASM instantiation failed: %s", error_buf);
+        return false;
+    }
+
+    wasm_exec_env_t exec_env = container_budget_exec_env(module_inst, budget);
+    if (exec_env)
+    {
+        if (profile)
+        {
+            container_profile_begin(exec_env);
+        }
+        control_container_t container;
+        control_bind_result_t bound = control_container_bind(&container, name, module_inst,
+                                                             exec_env, period_us);
+        if (bound == CONTROL_BIND_OK)
+        {
+            ok = control_container_set_budget(&container, budget)
+                 && run_step_container(&container);
+            control_container_unbind(&container);
+        }
+        else if (bound == CONTROL_BIND_NO_STEP)
+        {
+            ok = run_main_container(module_inst, exec_env);
+        }
+        if (profile)
+        {
+            container_profile_read(exec_env, profile);
+        }
+        wasm_runtime_destroy_exec_env(exec_env);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "Exec env creation failed");
+    }
+
+    wasm_runtime_deinstantiate(module_inst);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = DEFAULT_CONTAINER_DIR;
+    const char *store_path = NULL;
+    const char *name = "controller";
+    uint32_t period_ms = 100; // Same as the firmware
+    double sim_seconds = 3600.0;
+    double report_seconds = 600.0;
+    unsigned seed = 1;
+    const char *model = NULL;
+    const char *integrator_name = "rk4";
+    const char *wasm_path = NULL;
+    bool profiling = false;
+    plant_integrator_t integrator;
+    int opt;
+
+    setvbuf(stdout, NULL, _IOLBF, 0); // Keep logs line-ordered when piped
+
+    while ((opt = getopt(argc, argv, "d:c:n:t:s:r:S:m:i:w:P")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd': dir = optarg; break;
+        case 'c': store_path = optarg; break;
+        case 'n': name = optarg; break;
+        case 't': period_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 's': sim_seconds = atof(optarg); break;
+        case 'r': report_seconds = atof(optarg); break;
+        case 'S': seed = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'm': model = optarg; break;
+        case 'i': integrator_name = optarg; break;
+        case 'w': wasm_path = optarg; break;
+        case 'P': profiling = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-d container_dir] [-c container_store.bin] [-n name] "
+                            "[-t period_ms] "
+                            "[-s sim_seconds] [-r report_seconds] [-S seed] "
+                            "[-m model] [-i euler|rk4] [-w plant.wasm] [-P]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (period_ms == 0 || sim_seconds <= 0.0)
+    {
+        fprintf(stderr, "period and simulated time must be positive\n");
+        return 1;
+    }
+    if (!plant_integrator_parse(integrator_name, &integrator))
+    {
+        fprintf(stderr, "integrator must be euler or rk4\n");
+        return 1;
+    }
+    if (profiling && !container_profile_supported())
+    {
+        fprintf(stderr, "-P needs a build with -DWAMR_BUILD_MEMORY_PROFILING=1\n");
+        return 1;
+    }
+
+    // Sensor noise comes from random(): a fixed seed makes runs repeatable
+    srandom(seed);
+    bridge_sim_init(1);
+    if (model && !bridge_sim_set_model(model, integrator))
+    {
+        return 1;
+    }
+    heater_actuator_config_t heater_cfg = {.gpio = -1, .freq_hz = 1000, .fade_ms = 0};
+    heater_actuator_init(&heater_cfg);
+    heater_actuator_mock_set_sink(apply_heater_duty, NULL);
+    end_us = (uint64_t)(sim_seconds * 1e6);
+    report_us = (uint64_t)(report_seconds * 1e6);
+    next_report_us = report_us;
+    next_tick_us = tick_us;
+
+    RuntimeInitArgs init_args;
+    memset(&init_args, 0, sizeof(RuntimeInitArgs));
+    init_args.mem_alloc_type = Alloc_With_System_Allocator;
+    if (!wasm_runtime_full_init(&init_args))
+    {
+        ESP_LOGE(TAG, "WAMR Init Failed");
+        return 1;
+    }
+    wasm_runtime_register_natives("env", lockstep_symbols,
+                                  sizeof(lockstep_symbols) / sizeof(NativeSymbol));
+    control_executor_init_io(&lockstep_io_ops);
+    filter_natives_register();
+    wasm_plant_register_natives();
+
+    // WASM plant: one instance, stepped by the bridge tick
+    uint8_t *plant_buffer = NULL;
+    wasm_module_t plant_module = NULL;
+    wasm_plant_t *plant = NULL;
+    if (wasm_path)
+    {
+        plant_module = wasm_plant_load(wasm_path, &plant_buffer);
+        plant = plant_module ? wasm_plant_create_array(plant_module, wasm_path, 1) : NULL;
+        if (!plant)
+        {
+            return 1;
+        }
+        bridge_sim_set_external(wasm_plant_external_step, plant);
+        ESP_LOGI(TAG, "Plant model: %s (WASM)", wasm_path);
+    }
+
+    container_loader_set_dir(dir);
+    if (store_path && !container_store_open(store_path))
+    {
+        return 1;
+    }
+    uint8_t *buffer = NULL;
+    wasm_module_t module = load_container(name, &buffer);
+    if (!module)
+    {
+        ESP_LOGE(TAG, "Failed to load container %s from %s", name, dir);
+        return 1;
+    }
+
+    // Profiling runs with the defaults, so no peak is clipped by an old manifest
+    container_budget_t budget;
+    container_profile_t profile;
+    if (profiling)
+    {
+        container_budget_default(&budget);
+    }
+    else
+    {
+        container_budget_load(name, &budget);
+    }
+
+    int64_t wall_start = esp_timer_get_time();
+    bool ok = run_lockstep(module, name, period_ms * 1000, &budget, profiling ? &profile : NULL);
+    double wall_s = (esp_timer_get_time() - wall_start) / 1e6;
+
+    report_window();
+    ESP_LOGI(TAG, "simulated %.1f s in %.3f s wall: %.0f simulated s per wall s",
+             now_us / 1e6, wall_s, wall_s > 0.0 ? now_us / 1e6 / wall_s : 0.0);
+
+    if (profiling && ok)
+    {
+        char path[256];
+        char comment[256];
+        container_budget_load(name, &budget); // Keeps any step budgets it sets
+        container_profile_budget(&profile, &budget);
+        container_profile_log(name, &profile, &budget);
+        snprintf(path, sizeof(path), "%s/%s%s", dir, name, CONTAINER_BUDGET_EXT);
+        snprintf(comment, sizeof(comment),
+                 "%s: profiled by sim_lockstep over %.0f s\n"
+                 "peak wasm stack %lu B, app heap %lu B, native stack %lu B (host)",
+                 name, now_us / 1e6, (unsigned long)profile.wasm_stack,
+                 (unsigned long)profile.app_heap, (unsigned long)profile.native_stack);
+        ok = container_budget_write(path, &budget, comment);
+        if (ok)
+        {
+            ESP_LOGI(TAG, "Wrote %s", path);
+        }
+    }
+
+    wasm_runtime_unload(module);
+    if (plant)
+    {
+        bridge_sim_set_external(NULL, NULL);
+        wasm_plant_destroy_array(plant, 1);
+        wasm_runtime_unload(plant_module);
+        free(plant_buffer);
+    }
+    free(buffer);
+    wasm_runtime_destroy();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <stdio.h>
+
+// Linux stand-in for ESP-IDF logging so firmware sources build unchanged on
+// the host. Same call shape as the IDF macros; output goes to stdout/stderr.
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) fprintf(stdout, "I (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) do { } while (0)